@@ -0,0 +1,132 @@
+#include "BenchmarkRunner.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <map>
+
+static double secondsSince(int64_t startTicks)
+{
+    return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+BenchmarkRunner::BenchmarkRunner(juce::String nameFilter, double minSecondsPerCase)
+    : filter(std::move(nameFilter)), minSeconds(minSecondsPerCase)
+{
+}
+
+bool BenchmarkRunner::shouldRun(const juce::String& name) const
+{
+    return filter.isEmpty() || name.contains(filter);
+}
+
+void BenchmarkRunner::run(const juce::String& name, int64_t samplesPerCall, const juce::NamedValueSet& config,
+                          const std::function<void()>& fn)
+{
+    if (!shouldRun(name))
+        return;
+
+    constexpr int numBatches = 7;
+
+    for (int i = 0; i < 3; ++i)
+        fn();
+
+    auto timeBatch = [&fn](int64_t calls)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        for (int64_t i = 0; i < calls; ++i)
+            fn();
+        return secondsSince(start);
+    };
+
+    int64_t calls = 1;
+    while (calls < (int64_t { 1 } << 30) && timeBatch(calls) < minSeconds / numBatches)
+        calls *= 2;
+
+    std::array<double, numBatches> perCall {};
+    for (auto& t : perCall)
+        t = timeBatch(calls) / static_cast<double>(calls);
+
+    std::sort(perCall.begin(), perCall.end());
+    add(name, samplesPerCall, perCall[numBatches / 2] * 1.0e9, config);
+}
+
+void BenchmarkRunner::add(const juce::String& name, int64_t samplesPerCall, double nsPerCall, const juce::NamedValueSet& config)
+{
+    if (!shouldRun(name))
+        return;
+
+    Result result;
+    result.name = name;
+    result.samplesPerCall = samplesPerCall;
+    result.nsPerCall = nsPerCall;
+    result.nsPerSample = nsPerCall / static_cast<double>(std::max<int64_t>(1, samplesPerCall));
+    result.config = config;
+
+    report(result);
+    results.add(result);
+}
+
+void BenchmarkRunner::report(const Result& result)
+{
+    std::printf("%-52s %10.2f ns/sample %12.1f ns/call\n", result.name.toRawUTF8(), result.nsPerSample, result.nsPerCall);
+    std::fflush(stdout);
+}
+
+juce::var BenchmarkRunner::toJson() const
+{
+    juce::Array<juce::var> entries;
+
+    for (const auto& result : results)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty("name", result.name);
+        entry->setProperty("nsPerSample", result.nsPerSample);
+        entry->setProperty("nsPerCall", result.nsPerCall);
+        entry->setProperty("samplesPerCall", static_cast<juce::int64>(result.samplesPerCall));
+
+        auto* config = new juce::DynamicObject();
+        for (const auto& value : result.config)
+            config->setProperty(value.name, value.value);
+        entry->setProperty("config", juce::var(config));
+
+        entries.add(juce::var(entry));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("version", 1);
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    root->setProperty("time", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("results", entries);
+    return juce::var(root);
+}
+
+int BenchmarkRunner::compareWithBaseline(const juce::var& baseline, double tolerancePercent) const
+{
+    std::map<juce::String, double> reference;
+    if (auto* entries = baseline["results"].getArray())
+        for (const auto& entry : *entries)
+            reference[entry["name"].toString()] = static_cast<double>(entry["nsPerSample"]);
+
+    int regressions = 0;
+    std::printf("\n%-52s %12s %12s %8s\n", "case", "baseline", "current", "change");
+
+    for (const auto& result : results)
+    {
+        auto it = reference.find(result.name);
+        if (it == reference.end() || it->second <= 0.0)
+        {
+            std::printf("%-52s %12s %12.2f %8s\n", result.name.toRawUTF8(), "-", result.nsPerSample, "new");
+            continue;
+        }
+
+        double change = (result.nsPerSample / it->second - 1.0) * 100.0;
+        bool regressed = change > tolerancePercent;
+        regressions += regressed ? 1 : 0;
+
+        std::printf("%-52s %12.2f %12.2f %+7.1f%%%s\n", result.name.toRawUTF8(), it->second, result.nsPerSample,
+                    change, regressed ? "  SLOWER" : "");
+    }
+
+    return regressions;
+}
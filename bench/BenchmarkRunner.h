@@ -0,0 +1,46 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <cstdint>
+#include <functional>
+
+// Times benchmark cases and collects them for the console table and the JSON report.
+class BenchmarkRunner
+{
+public:
+    struct Result
+    {
+        juce::String name;          // unique key used to match a baseline, e.g. "oscillator/saw/block"
+        double nsPerSample = 0.0;
+        double nsPerCall = 0.0;
+        int64_t samplesPerCall = 0;
+        juce::NamedValueSet config; // the case's parameters, copied into the JSON
+    };
+
+    BenchmarkRunner(juce::String nameFilter, double minSecondsPerCase);
+
+    bool shouldRun(const juce::String& name) const;
+
+    // Calls fn in batches until each batch lasts long enough to time reliably, then
+    // records the median time per call. fn processes samplesPerCall samples.
+    void run(const juce::String& name, int64_t samplesPerCall, const juce::NamedValueSet& config,
+             const std::function<void()>& fn);
+
+    // For cases that time themselves; nsPerCall is divided by samplesPerCall.
+    void add(const juce::String& name, int64_t samplesPerCall, double nsPerCall, const juce::NamedValueSet& config);
+
+    const juce::Array<Result>& getResults() const { return results; }
+
+    juce::var toJson() const;
+
+    // Prints each result against the matching baseline entry. Returns the number of
+    // cases more than tolerancePercent slower than the baseline.
+    int compareWithBaseline(const juce::var& baseline, double tolerancePercent) const;
+
+private:
+    void report(const Result& result);
+
+    juce::String filter;
+    double minSeconds;
+    juce::Array<Result> results;
+};
@@ -0,0 +1,429 @@
+#include "BenchmarkRunner.h"
+#include "PluginProcessor.h"
+#include "ParameterIDs.h"
+#include "dsp/HalfbandDecimator.h"
+#include "dsp/Oscillator.h"
+#include "dsp/PitchDetectorGroup.h"
+#include "dsp/PitchSmoother.h"
+#include "dsp/YinPitchDetector.h"
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static const double sampleRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+static const char* const waveformNames[] = { "sine", "triangle", "square", "saw" };
+
+// A 220 Hz tone with a few harmonics: steady enough for the tracker to lock on.
+static std::vector<float> makeTone(double sampleRate, int numSamples)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    auto w = juce::MathConstants<double>::twoPi * 220.0 / sampleRate;
+
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = static_cast<float>(0.3 * std::sin(w * i) + 0.15 * std::sin(2.0 * w * i)
+                                                         + 0.075 * std::sin(3.0 * w * i));
+    return out;
+}
+
+static void setParameter(HdnRingmodAudioProcessor& processor, const char* id, float value)
+{
+    auto* parameter = processor.apvts.getParameter(id);
+    parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+}
+
+static void benchProcessBlock(BenchmarkRunner& runner)
+{
+    const int blockSizes[] = { 1, 16, 64, 256, 512, 1024, 4096 };
+    const char* const modeNames[] = { "pitch", "manual" };
+
+    for (auto sampleRate : sampleRates)
+    {
+        // A whole number of the largest block, so no block straddles the loop point.
+        int loopLength = 4096 * static_cast<int>(std::ceil(sampleRate / 4096.0));
+        auto tone = makeTone(sampleRate, loopLength);
+
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            for (int waveform = 0; waveform < 4; ++waveform)
+            {
+                for (int blockSize : blockSizes)
+                {
+                    auto name = juce::String("processBlock/") + modeNames[mode] + "/" + waveformNames[waveform]
+                              + "/" + juce::String(juce::roundToInt(sampleRate)) + "/" + juce::String(blockSize);
+                    if (!runner.shouldRun(name))
+                        continue;
+
+                    HdnRingmodAudioProcessor processor;
+                    setParameter(processor, ParameterIDs::mode, static_cast<float>(mode));
+                    setParameter(processor, ParameterIDs::waveform, static_cast<float>(waveform));
+                    processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+                    processor.prepareToPlay(sampleRate, blockSize);
+
+                    juce::AudioBuffer<float> buffer(2, blockSize);
+                    juce::MidiBuffer midi;
+                    int position = 0;
+
+                    juce::NamedValueSet config;
+                    config.set("mode", modeNames[mode]);
+                    config.set("waveform", waveformNames[waveform]);
+                    config.set("sampleRate", sampleRate);
+                    config.set("blockSize", blockSize);
+
+                    // Includes refilling the block from the loop, well under 1% of the total.
+                    runner.run(name, blockSize, config, [&]
+                    {
+                        for (int ch = 0; ch < 2; ++ch)
+                            std::copy_n(tone.data() + position, blockSize, buffer.getWritePointer(ch));
+
+                        processor.processBlock(buffer, midi);
+                        position = (position + blockSize) % loopLength;
+                    });
+
+                    processor.releaseResources();
+                }
+            }
+        }
+    }
+}
+
+// Pitch tracking on wider buses: one detector on the downmix and one carrier shared
+// by every channel, so the cost per channel should fall as channels are added.
+static void benchChannels(BenchmarkRunner& runner)
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    int loopLength = blockSize * static_cast<int>(std::ceil(sampleRate / blockSize));
+    auto tone = makeTone(sampleRate, loopLength);
+
+    for (int numChannels : { 1, 2, 6, 12, 16 })
+    {
+        auto name = "channels/pitch/48000/512/" + juce::String(numChannels);
+        if (!runner.shouldRun(name))
+            continue;
+
+        HdnRingmodAudioProcessor processor;
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        int position = 0;
+
+        juce::NamedValueSet config;
+        config.set("channels", numChannels);
+        config.set("sampleRate", sampleRate);
+        config.set("blockSize", blockSize);
+
+        runner.run(name, blockSize, config, [&]
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                std::copy_n(tone.data() + position, blockSize, buffer.getWritePointer(ch));
+
+            processor.processBlock(buffer, midi);
+            position = (position + blockSize) % loopLength;
+        });
+
+        processor.releaseResources();
+    }
+}
+
+// Runs the detector synchronously so the analysis is timed on this thread, with the
+// decimator and the hop bookkeeping included.
+static void benchPitchDetector(BenchmarkRunner& runner)
+{
+    const std::pair<const char*, YinPitchDetector::DifferenceMode> modes[] = {
+        { "batch", YinPitchDetector::DifferenceMode::Batch },
+        { "sliding", YinPitchDetector::DifferenceMode::Sliding },
+        { "coarseToFine", YinPitchDetector::DifferenceMode::CoarseToFine }
+    };
+
+    for (auto sampleRate : sampleRates)
+    {
+        auto numSamples = static_cast<int>(sampleRate * 2.0);
+        auto tone = makeTone(sampleRate, numSamples);
+
+        for (const auto& [modeName, mode] : modes)
+        {
+            auto name = juce::String("detector/") + modeName + "/" + juce::String(juce::roundToInt(sampleRate));
+            if (!runner.shouldRun(name))
+                continue;
+
+            YinPitchDetector detector;
+            detector.setSynchronous(true);
+            detector.setDifferenceMode(mode);
+            detector.setMaxHopSeconds(0.003);
+
+            double bestNsPerAnalysis = 0.0;
+            uint32_t analyses = 0;
+
+            for (int run = 0; run < 5; ++run)
+            {
+                detector.prepare(sampleRate);
+
+                auto start = juce::Time::getHighResolutionTicks();
+                detector.feedBlock(tone.data(), numSamples);
+                auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                analyses = std::max(1u, detector.getNumAnalyses());
+                auto nsPerAnalysis = seconds * 1.0e9 / analyses;
+                bestNsPerAnalysis = run == 0 ? nsPerAnalysis : std::min(bestNsPerAnalysis, nsPerAnalysis);
+            }
+
+            juce::NamedValueSet config;
+            config.set("differenceMode", modeName);
+            config.set("sampleRate", sampleRate);
+            config.set("hopSeconds", 0.003);
+            config.set("analyses", static_cast<int>(analyses));
+
+            runner.add(name, numSamples / static_cast<int>(analyses), bestNsPerAnalysis, config);
+        }
+    }
+}
+
+// Unlinked tracking: a pooled group in batch mode, so every hop needs the FFT, fed
+// in step like the processor does. The cost is the analysis time the detectors
+// report, summed over the channels, per hop; with two channels the hops are
+// transformed in pairs, so the 2-channel case is reported against the 1-channel one.
+static void benchDetectorGroup(BenchmarkRunner& runner)
+{
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    auto numSamples = static_cast<int>(sampleRate * 2.0);
+    auto tone = makeTone(sampleRate, numSamples);
+    double oneChannelNs = 0.0;
+
+    for (int numChannels : { 1, 2 })
+    {
+        auto name = "detectorGroup/batch/48000/" + juce::String(numChannels);
+        if (!runner.shouldRun(name))
+            continue;
+
+        PitchDetectorGroup group;
+        group.setDifferenceMode(YinPitchDetector::DifferenceMode::Batch);
+
+        double bestNsPerHop = 0.0;
+        uint32_t hops = 0;
+        uint32_t pairs = 0;
+
+        for (int run = 0; run < 5; ++run)
+        {
+            group.prepare(sampleRate, numChannels);
+
+            for (int offset = 0; offset < numSamples; offset += blockSize)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    group.feedBlock(ch, tone.data() + offset, std::min(blockSize, numSamples - offset));
+            group.flushForTest();
+
+            double totalMs = 0.0;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto telemetry = group.getDetector(ch).getTelemetry();
+                totalMs += telemetry.meanAnalyseMs * telemetry.numAnalyses;
+            }
+
+            hops = std::max(1u, group.getDetector(0).getNumAnalyses());
+            pairs = group.getNumBatchedPairs();
+            auto nsPerHop = totalMs * 1.0e6 / hops;
+            bestNsPerHop = run == 0 ? nsPerHop : std::min(bestNsPerHop, nsPerHop);
+        }
+
+        juce::NamedValueSet config;
+        config.set("differenceMode", "batch");
+        config.set("sampleRate", sampleRate);
+        config.set("channels", numChannels);
+        config.set("hops", static_cast<int>(hops));
+        config.set("batchedPairs", static_cast<int>(pairs));
+
+        if (numChannels == 1)
+            oneChannelNs = bestNsPerHop;
+        else if (oneChannelNs > 0.0)
+            config.set("costRatio", bestNsPerHop / oneChannelNs);
+
+        runner.add(name, numSamples / static_cast<int>(hops), bestNsPerHop, config);
+    }
+}
+
+static void benchDecimator(BenchmarkRunner& runner)
+{
+    const std::pair<const char*, HalfbandDecimator::Design> designs[] = {
+        { "compact", HalfbandDecimator::Design::Compact },
+        { "steep", HalfbandDecimator::Design::Steep }
+    };
+
+    constexpr int blockSize = 512;
+    auto tone = makeTone(48000.0, blockSize);
+    std::vector<float> out(blockSize / 2 + 1);
+
+    for (const auto& [designName, design] : designs)
+    {
+        HalfbandDecimator decimator;
+        decimator.setDesign(design);
+
+        juce::NamedValueSet config;
+        config.set("design", designName);
+        config.set("blockSize", blockSize);
+
+        runner.run(juce::String("decimator/") + designName, blockSize, config, [&]
+        {
+            decimator.process(tone.data(), blockSize, out.data());
+        });
+    }
+}
+
+static void benchOscillator(BenchmarkRunner& runner)
+{
+    constexpr int blockSize = 512;
+    constexpr int controlBlock = 32;
+    std::vector<float> out(blockSize);
+
+    for (bool fixedPoint : { false, true })
+    {
+        for (int waveform = 0; waveform < 4; ++waveform)
+        {
+            Oscillator oscillator;
+            oscillator.prepare(48000.0);
+            oscillator.setFixedPointPhase(fixedPoint);
+            oscillator.setWaveform(static_cast<Oscillator::Waveform>(waveform));
+            oscillator.setFrequency(220.0f);
+
+            juce::NamedValueSet config;
+            config.set("waveform", waveformNames[waveform]);
+            config.set("sampleRate", 48000.0);
+            config.set("blockSize", blockSize);
+            config.set("phase", fixedPoint ? "fixed" : "double");
+
+            auto name = juce::String("oscillator/") + waveformNames[waveform] + (fixedPoint ? "/fixed" : "");
+
+            runner.run(name + "/hold", blockSize, config, [&]
+            {
+                oscillator.renderBlock(out.data(), blockSize);
+            });
+
+            // Glides between two pitches in control blocks, as the pitch-track path does.
+            bool up = false;
+            runner.run(name + "/glide", blockSize, config, [&]
+            {
+                for (int offset = 0; offset < blockSize; offset += controlBlock)
+                    oscillator.renderLogRamp(out.data() + offset, controlBlock, up ? 233.0f : 220.0f);
+                up = !up;
+            });
+        }
+    }
+}
+
+static void benchPitchSmoother(BenchmarkRunner& runner)
+{
+    constexpr int blockSize = 512;
+    constexpr int controlBlock = 32;
+
+    // Jitter of a few cents, so the smoothed value keeps moving.
+    std::vector<float> detected(blockSize);
+    for (int i = 0; i < blockSize; ++i)
+        detected[static_cast<size_t>(i)] = 220.0f * (1.0f + 0.002f * std::sin(0.05f * static_cast<float>(i)));
+
+    juce::NamedValueSet config;
+    config.set("sampleRate", 48000.0);
+    config.set("blockSize", blockSize);
+
+    PitchSmoother smoother;
+    smoother.prepare(48000.0);
+    float sink = 0.0f;
+
+    runner.run("pitchSmoother/perSample", blockSize, config, [&]
+    {
+        for (int i = 0; i < blockSize; ++i)
+            sink += smoother.process(detected[static_cast<size_t>(i)], 1.0f);
+    });
+
+    smoother.prepare(48000.0);
+    smoother.setBlockSize(controlBlock);
+
+    runner.run("pitchSmoother/controlBlock", blockSize, config, [&]
+    {
+        for (int offset = 0; offset < blockSize; offset += controlBlock)
+            sink += smoother.processBlock(detected[static_cast<size_t>(offset)], 1.0f, controlBlock);
+    });
+
+    juce::ignoreUnused(sink);
+}
+
+static void printUsage()
+{
+    std::cout << "Usage: HdnRingmodBench [options]\n"
+                 "\n"
+                 "  -f, --filter <text>       only run cases whose name contains text,\n"
+                 "                            e.g. processBlock/pitch or detector/\n"
+                 "  -t, --min-time <seconds>  time spent measuring each case (default: 0.1)\n"
+                 "      --json <file>         write the results as JSON\n"
+                 "      --baseline <file>     compare against an earlier --json report\n"
+                 "      --tolerance <percent> slowdown reported as a regression (default: 10)\n"
+                 "  -h, --help                show this message\n"
+                 "\n"
+                 "Exits with 1 if any case is slower than the baseline by more than the tolerance.\n";
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ScopedNoDenormals noDenormals;
+
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+    juce::String filter;
+    double minSeconds = 0.1;
+    double tolerance = 10.0;
+    juce::File jsonFile, baselineFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg(argv[i]);
+        auto hasValue = i + 1 < argc;
+
+        if ((arg == "-f" || arg == "--filter") && hasValue)
+            filter = argv[++i];
+        else if ((arg == "-t" || arg == "--min-time") && hasValue)
+            minSeconds = juce::jmax(0.001, juce::String(argv[++i]).getDoubleValue());
+        else if (arg == "--json" && hasValue)
+            jsonFile = cwd.getChildFile(argv[++i]);
+        else if (arg == "--baseline" && hasValue)
+            baselineFile = cwd.getChildFile(argv[++i]);
+        else if (arg == "--tolerance" && hasValue)
+            tolerance = juce::String(argv[++i]).getDoubleValue();
+        else
+        {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    juce::var baseline;
+    if (baselineFile != juce::File())
+    {
+        baseline = juce::JSON::parse(baselineFile);
+        if (!baseline.isObject())
+        {
+            std::cerr << "HdnRingmodBench: cannot read baseline " << baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner(filter, minSeconds);
+
+    benchProcessBlock(runner);
+    benchChannels(runner);
+    benchPitchDetector(runner);
+    benchDetectorGroup(runner);
+    benchDecimator(runner);
+    benchOscillator(runner);
+    benchPitchSmoother(runner);
+
+    if (jsonFile != juce::File() && !jsonFile.replaceWithText(juce::JSON::toString(runner.toJson())))
+    {
+        std::cerr << "HdnRingmodBench: cannot write " << jsonFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (baseline.isObject() && runner.compareWithBaseline(baseline, tolerance) > 0)
+        return 1;
+
+    return 0;
+}
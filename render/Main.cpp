@@ -0,0 +1,191 @@
+#include "OfflineRenderer.h"
+#include <iostream>
+
+static void printUsage()
+{
+    std::cout << "Usage: HdnRingmodRender [options] <file or directory>...\n"
+                 "\n"
+                 "Renders WAV/AIFF files through the HDN Ring Modulator faster than realtime.\n"
+                 "Directories are searched recursively and mirrored under the output directory.\n"
+                 "\n"
+                 "  -o, --output <dir>        output directory (required)\n"
+                 "  -s, --state <file>        plugin state saved by getStateInformation, or its XML\n"
+                 "  -p, --param <id>=<value>  set a parameter after the state, e.g. mix=75 or\n"
+                 "                            waveform=Saw; may be repeated\n"
+                 "  -j, --jobs <n>            files rendered in parallel (default: CPU count)\n"
+                 "  -b, --block-size <n>      samples per processBlock call (default: 512)\n"
+                 "      --list-params         print the parameter IDs and ranges, then exit\n"
+                 "  -h, --help                show this message\n";
+}
+
+static int fail(const juce::String& message)
+{
+    std::cerr << "HdnRingmodRender: " << message << std::endl;
+    return 1;
+}
+
+static void listParameters(HdnRingmodAudioProcessor& processor)
+{
+    for (auto* p : processor.getParameters())
+    {
+        auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(p);
+        if (parameter == nullptr)
+            continue;
+
+        std::cout << parameter->paramID << " (" << parameter->getName(64) << "): ";
+
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(parameter))
+        {
+            std::cout << choice->choices.joinIntoString(" / ");
+        }
+        else
+        {
+            const auto& range = parameter->getNormalisableRange();
+            std::cout << range.start << " to " << range.end << " " << parameter->getLabel();
+        }
+
+        std::cout << ", default " << parameter->getText(parameter->getDefaultValue(), 64) << std::endl;
+    }
+}
+
+static juce::Result loadState(const juce::File& file, juce::MemoryBlock& state)
+{
+    if (file.hasFileExtension("xml"))
+    {
+        auto xml = juce::parseXML(file);
+        if (xml == nullptr)
+            return juce::Result::fail("cannot parse " + file.getFullPathName());
+
+        juce::AudioProcessor::copyXmlToBinary(*xml, state);
+        return juce::Result::ok();
+    }
+
+    if (!file.loadFileAsData(state))
+        return juce::Result::fail("cannot read " + file.getFullPathName());
+
+    return juce::Result::ok();
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto cwd = juce::File::getCurrentWorkingDirectory();
+    OfflineRenderer::Settings settings;
+    juce::File outputDir;
+    juce::StringArray inputs;
+    int numThreads = juce::SystemStats::getNumCpus();
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        juce::String arg(argv[i]);
+        auto hasValue = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help")
+        {
+            printUsage();
+            return 0;
+        }
+
+        if (arg == "--list-params")
+        {
+            list = true;
+        }
+        else if ((arg == "-o" || arg == "--output") && hasValue)
+        {
+            outputDir = cwd.getChildFile(argv[++i]);
+        }
+        else if ((arg == "-s" || arg == "--state") && hasValue)
+        {
+            if (auto result = loadState(cwd.getChildFile(argv[++i]), settings.state); result.failed())
+                return fail(result.getErrorMessage());
+        }
+        else if ((arg == "-p" || arg == "--param") && hasValue)
+        {
+            juce::String assignment(argv[++i]);
+            if (!assignment.containsChar('='))
+                return fail("expected <id>=<value>, got '" + assignment + "'");
+
+            settings.parameters.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+                                    assignment.fromFirstOccurrenceOf("=", false, false).trim());
+        }
+        else if ((arg == "-j" || arg == "--jobs") && hasValue)
+        {
+            numThreads = juce::String(argv[++i]).getIntValue();
+            if (numThreads < 1)
+                return fail("--jobs needs a positive count");
+        }
+        else if ((arg == "-b" || arg == "--block-size") && hasValue)
+        {
+            settings.blockSize = juce::String(argv[++i]).getIntValue();
+            if (settings.blockSize < 1 || settings.blockSize > 65536)
+                return fail("--block-size must be between 1 and 65536");
+        }
+        else if (arg.startsWith("-"))
+        {
+            printUsage();
+            return fail("unknown or incomplete option " + arg);
+        }
+        else
+        {
+            inputs.add(arg);
+        }
+    }
+
+    OfflineRenderer renderer(std::move(settings));
+
+    // Catches a bad state file or parameter once, rather than once per file.
+    std::unique_ptr<HdnRingmodAudioProcessor> processor;
+    if (auto result = renderer.createProcessor(processor); result.failed())
+        return fail(result.getErrorMessage());
+
+    if (list)
+    {
+        listParameters(*processor);
+        return 0;
+    }
+
+    processor.reset();
+
+    if (inputs.isEmpty())
+    {
+        printUsage();
+        return fail("no input files");
+    }
+
+    if (outputDir == juce::File())
+        return fail("no output directory; pass --output <dir>");
+
+    juce::Array<OfflineRenderer::Job> jobs;
+
+    for (const auto& input : inputs)
+    {
+        auto file = cwd.getChildFile(input);
+
+        if (file.isDirectory())
+        {
+            for (const auto& entry : juce::RangedDirectoryIterator(file, true, "*.wav;*.aif;*.aiff"))
+                jobs.add({ entry.getFile(), outputDir.getChildFile(entry.getFile().getRelativePathFrom(file)) });
+        }
+        else if (file.existsAsFile())
+        {
+            jobs.add({ file, outputDir.getChildFile(file.getFileName()) });
+        }
+        else
+        {
+            return fail("no such file or directory: " + input);
+        }
+    }
+
+    for (const auto& job : jobs)
+        if (job.input == job.output)
+            return fail("output would overwrite its input: " + job.input.getFullPathName());
+
+    int failures = renderer.renderAll(jobs, numThreads);
+
+    if (failures > 0)
+        return fail(juce::String(failures) + " of " + juce::String(jobs.size()) + " files failed");
+
+    return 0;
+}
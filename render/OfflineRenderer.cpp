@@ -0,0 +1,251 @@
+#include "OfflineRenderer.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static juce::Result parseParameterValue(juce::RangedAudioParameter& parameter, const juce::String& text, float& normalised)
+{
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*>(&parameter))
+    {
+        int index = choice->choices.indexOf(text, true);
+        if (index < 0 && text.isNotEmpty() && text.containsOnly("0123456789"))
+            index = text.getIntValue();
+
+        if (index < 0 || index >= choice->choices.size())
+            return juce::Result::fail("'" + text + "' is not one of " + choice->choices.joinIntoString(", "));
+
+        normalised = parameter.convertTo0to1(static_cast<float>(index));
+        return juce::Result::ok();
+    }
+
+    if (text.isEmpty() || !text.containsOnly("0123456789.-+eE"))
+        return juce::Result::fail("'" + text + "' is not a number");
+
+    auto value = text.getFloatValue();
+    const auto& range = parameter.getNormalisableRange();
+    if (value < range.start || value > range.end)
+        return juce::Result::fail(text + " is outside " + juce::String(range.start) + " to " + juce::String(range.end));
+
+    normalised = parameter.convertTo0to1(value);
+    return juce::Result::ok();
+}
+
+OfflineRenderer::OfflineRenderer(Settings s)
+    : settings(std::move(s))
+{
+    settings.blockSize = juce::jmax(1, settings.blockSize);
+    // Whole blocks per chunk, so every processBlock call but the last has the same size.
+    settings.chunkSize = juce::jmax(1, settings.chunkSize / settings.blockSize) * settings.blockSize;
+}
+
+juce::Result OfflineRenderer::createProcessor(std::unique_ptr<HdnRingmodAudioProcessor>& processor) const
+{
+    processor = std::make_unique<HdnRingmodAudioProcessor>();
+
+    if (!settings.state.isEmpty())
+    {
+        auto size = static_cast<int>(settings.state.getSize());
+        auto xml = juce::AudioProcessor::getXmlFromBinary(settings.state.getData(), size);
+        if (xml == nullptr || !xml->hasTagName(processor->apvts.state.getType()))
+            return juce::Result::fail("the state file is not an HDN Ring Modulator state");
+
+        processor->setStateInformation(settings.state.getData(), size);
+    }
+
+    for (const auto& id : settings.parameters.getAllKeys())
+    {
+        auto* parameter = processor->apvts.getParameter(id);
+        if (parameter == nullptr)
+            return juce::Result::fail("unknown parameter '" + id + "'");
+
+        float normalised = 0.0f;
+        auto result = parseParameterValue(*parameter, settings.parameters[id], normalised);
+        if (result.failed())
+            return juce::Result::fail(id + ": " + result.getErrorMessage());
+
+        parameter->setValueNotifyingHost(normalised);
+    }
+
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::render(const Job& job, double& secondsOfAudio) const
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(job.input));
+    if (reader == nullptr)
+        return juce::Result::fail("not a readable audio file");
+
+    auto numChannels = static_cast<int>(reader->numChannels);
+    if (numChannels < 1 || numChannels > HdnRingmodAudioProcessor::maxChannels)
+        return juce::Result::fail("only files with 1 to " + juce::String(HdnRingmodAudioProcessor::maxChannels)
+                                  + " channels are supported");
+
+    auto* format = formats.findFormatForFileExtension(job.output.getFileExtension());
+    if (format == nullptr)
+        return juce::Result::fail("no writer for " + job.output.getFileExtension() + " files");
+
+    std::unique_ptr<HdnRingmodAudioProcessor> processor;
+    if (auto result = createProcessor(processor); result.failed())
+        return result;
+
+    if (auto result = job.output.getParentDirectory().createDirectory(); result.failed())
+        return result;
+
+    job.output.deleteFile();
+    auto stream = std::make_unique<juce::FileOutputStream>(job.output);
+    if (stream->failedToOpen())
+        return juce::Result::fail("cannot write " + job.output.getFullPathName());
+
+    auto bitDepth = static_cast<int>(reader->bitsPerSample);
+    if (!format->getPossibleBitDepths().contains(bitDepth))
+        bitDepth = 24;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader->sampleRate,
+                                                                            static_cast<unsigned int>(numChannels),
+                                                                            bitDepth, reader->metadataValues, 0));
+    if (writer == nullptr)
+        return juce::Result::fail("cannot write " + juce::String(bitDepth) + "-bit " + format->getFormatName());
+
+    stream.release();
+
+    auto read = [&reader](juce::AudioBuffer<float>& chunk, int count, juce::int64 position)
+    {
+        return reader->read(&chunk, 0, count, position, true, true);
+    };
+    auto write = [&writer](const juce::AudioBuffer<float>& chunk, int start, int count)
+    {
+        return writer->writeFromAudioSampleBuffer(chunk, start, count);
+    };
+
+    auto length = reader->lengthInSamples;
+    if (auto result = renderStream(*processor, numChannels, reader->sampleRate, length, read, write); result.failed())
+    {
+        writer.reset();
+        job.output.deleteFile();
+        return result;
+    }
+
+    secondsOfAudio = static_cast<double>(length) / reader->sampleRate;
+    return juce::Result::ok();
+}
+
+juce::Result OfflineRenderer::renderBuffer(juce::AudioBuffer<float>& audio, double sampleRate) const
+{
+    auto numChannels = audio.getNumChannels();
+    if (numChannels < 1 || numChannels > HdnRingmodAudioProcessor::maxChannels)
+        return juce::Result::fail("only 1 to " + juce::String(HdnRingmodAudioProcessor::maxChannels)
+                                  + " channels are supported");
+
+    std::unique_ptr<HdnRingmodAudioProcessor> processor;
+    if (auto result = createProcessor(processor); result.failed())
+        return result;
+
+    juce::AudioBuffer<float> input(audio);
+    auto read = [&input, numChannels](juce::AudioBuffer<float>& chunk, int count, juce::int64 position)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunk.copyFrom(ch, 0, input, ch, static_cast<int>(position), count);
+        return true;
+    };
+
+    int outputPosition = 0;
+    auto write = [&audio, &outputPosition, numChannels](const juce::AudioBuffer<float>& chunk, int start, int count)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            audio.copyFrom(ch, outputPosition, chunk, ch, start, count);
+        outputPosition += count;
+        return true;
+    };
+
+    return renderStream(*processor, numChannels, sampleRate, audio.getNumSamples(), read, write);
+}
+
+// The processor's output runs getLatencySamples() behind its input. That much is
+// dropped from the start, and the input is padded with as many zeros to flush the
+// delayed tail, so the output has the input's length and lines up with it.
+juce::Result OfflineRenderer::renderStream(HdnRingmodAudioProcessor& processor, int numChannels, double sampleRate,
+                                           juce::int64 length, const ReadFunction& read, const WriteFunction& write) const
+{
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+    processor.prepareToPlay(sampleRate, settings.blockSize);
+
+    auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+    juce::AudioBuffer<float> chunk(numChannels, settings.chunkSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 position = 0; position < length + latency; position += settings.chunkSize)
+    {
+        auto count = static_cast<int>(juce::jmin<juce::int64>(settings.chunkSize, length + latency - position));
+        auto fromInput = static_cast<int>(juce::jlimit<juce::int64>(0, count, length - position));
+
+        if (fromInput > 0 && !read(chunk, fromInput, position))
+            return juce::Result::fail("read error at sample " + juce::String(position));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunk.clear(ch, fromInput, count - fromInput);
+
+        for (int offset = 0; offset < count; offset += settings.blockSize)
+        {
+            juce::AudioBuffer<float> block(chunk.getArrayOfWritePointers(), numChannels, offset,
+                                           juce::jmin(settings.blockSize, count - offset));
+            processor.processBlock(block, midi);
+        }
+
+        auto skip = static_cast<int>(juce::jlimit<juce::int64>(0, count, latency - position));
+        if (skip < count && !write(chunk, skip, count - skip))
+            return juce::Result::fail("write error at sample " + juce::String(position + skip - latency));
+    }
+
+    processor.releaseResources();
+    return juce::Result::ok();
+}
+
+int OfflineRenderer::renderAll(const juce::Array<Job>& jobs, int numThreads) const
+{
+    std::atomic<int> nextJob { 0 };
+    std::atomic<int> failures { 0 };
+    std::mutex reportLock;
+
+    auto worker = [&]
+    {
+        for (int index = nextJob++; index < jobs.size(); index = nextJob++)
+        {
+            const auto& job = jobs.getReference(index);
+            double secondsOfAudio = 0.0;
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            auto result = render(job, secondsOfAudio);
+            auto elapsed = (juce::Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+            std::scoped_lock lock(reportLock);
+
+            if (result.failed())
+            {
+                ++failures;
+                std::cerr << job.input.getFullPathName() << ": " << result.getErrorMessage() << std::endl;
+            }
+            else
+            {
+                std::cout << job.output.getFullPathName() << ": " << juce::String(secondsOfAudio, 1) << " s in "
+                          << juce::String(elapsed, 2) << " s ("
+                          << juce::String(secondsOfAudio / juce::jmax(elapsed, 1.0e-3), 1) << "x realtime)" << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < juce::jmin(numThreads, jobs.size()); ++i)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return failures.load();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "PluginProcessor.h"
+#include <functional>
+#include <memory>
+
+// Runs HdnRingmodAudioProcessor over audio files without a host. Each file gets a
+// fresh processor, and long files are streamed through in fixed-size chunks.
+class OfflineRenderer
+{
+public:
+    struct Settings
+    {
+        juce::MemoryBlock state;               // from getStateInformation; applied first
+        juce::StringPairArray parameters;      // parameter ID -> value text, e.g. "mix" -> "75"
+        int blockSize = 512;
+        int chunkSize = 1 << 16;
+    };
+
+    struct Job
+    {
+        juce::File input;
+        juce::File output;
+    };
+
+    explicit OfflineRenderer(Settings settings);
+
+    // Builds a processor with the state and parameters applied. Fails on an unreadable
+    // state blob, an unknown parameter ID or a value the parameter does not accept.
+    juce::Result createProcessor(std::unique_ptr<HdnRingmodAudioProcessor>& processor) const;
+
+    // Renders one file. Thread-safe; the output format follows the output extension.
+    // The plugin's latency is compensated, so the output lines up with the input.
+    juce::Result render(const Job& job, double& secondsOfAudio) const;
+
+    // As render(), for audio already in memory; the buffer is replaced in place.
+    juce::Result renderBuffer(juce::AudioBuffer<float>& audio, double sampleRate) const;
+
+    // Renders every job on numThreads threads and reports each file as it finishes.
+    // Returns the number of jobs that failed.
+    int renderAll(const juce::Array<Job>& jobs, int numThreads) const;
+
+private:
+    using ReadFunction = std::function<bool(juce::AudioBuffer<float>& chunk, int numSamples, juce::int64 position)>;
+    using WriteFunction = std::function<bool(const juce::AudioBuffer<float>& chunk, int startSample, int numSamples)>;
+
+    juce::Result renderStream(HdnRingmodAudioProcessor& processor, int numChannels, double sampleRate, juce::int64 length,
+                              const ReadFunction& read, const WriteFunction& write) const;
+
+    Settings settings;
+
+    JUCE_DECLARE_NON_COPYABLE(OfflineRenderer)
+};
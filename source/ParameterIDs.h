@@ -9,4 +9,8 @@ namespace ParameterIDs
     inline constexpr const char* smoothing      = "smoothing";
     inline constexpr const char* sensitivity    = "sensitivity";
     inline constexpr const char* waveform       = "waveform";
+    inline constexpr const char* lookahead      = "lookahead";
+    inline constexpr const char* detectSource   = "detectSource";
+    inline constexpr const char* detectChannel  = "detectChannel";
+    inline constexpr const char* detectCount    = "detectCount";
 }
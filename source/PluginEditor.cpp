@@ -21,12 +21,14 @@ HdnRingmodAudioProcessorEditor::HdnRingmodAudioProcessorEditor(HdnRingmodAudioPr
     setupSlider(manualRateSlider, manualRateLabel, "Manual Rate");
     setupSlider(smoothingSlider, smoothingLabel, "Smoothing");
     setupSlider(sensitivitySlider, sensitivityLabel, "Sensitivity");
+    setupSlider(lookaheadSlider, lookaheadLabel, "Lookahead");
 
     mixAttach        = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::mix, mixSlider);
     rateMultAttach   = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::rateMultiplier, rateMultSlider);
     manualRateAttach = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::manualRate, manualRateSlider);
     smoothingAttach  = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::smoothing, smoothingSlider);
     sensitivityAttach = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::sensitivity, sensitivitySlider);
+    lookaheadAttach  = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::lookahead, lookaheadSlider);
 
     auto setupCombo = [&](juce::ComboBox& box, juce::Label& label, const juce::String& text,
                            const juce::String& paramID)
@@ -42,16 +44,40 @@ HdnRingmodAudioProcessorEditor::HdnRingmodAudioProcessorEditor(HdnRingmodAudioPr
 
     setupCombo(modeBox, modeLabel, "Mode", ParameterIDs::mode);
     setupCombo(waveformBox, waveformLabel, "Waveform", ParameterIDs::waveform);
+    setupCombo(detectSourceBox, detectSourceLabel, "Detect", ParameterIDs::detectSource);
 
     modeAttach     = std::make_unique<ComboBoxAttachment>(p.apvts, ParameterIDs::mode, modeBox);
     waveformAttach = std::make_unique<ComboBoxAttachment>(p.apvts, ParameterIDs::waveform, waveformBox);
+    detectSourceAttach = std::make_unique<ComboBoxAttachment>(p.apvts, ParameterIDs::detectSource, detectSourceBox);
+
+    auto setupStepper = [this](juce::Slider& slider, juce::Label& label, const juce::String& text)
+    {
+        slider.setSliderStyle(juce::Slider::IncDecButtons);
+        slider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 40, 20);
+        addAndMakeVisible(slider);
+
+        label.setText(text, juce::dontSendNotification);
+        label.setJustificationType(juce::Justification::centredRight);
+        addAndMakeVisible(label);
+    };
+
+    setupStepper(detectChannelSlider, detectChannelLabel, "Channel");
+    setupStepper(detectCountSlider, detectCountLabel, "Count");
+
+    detectChannelAttach = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::detectChannel, detectChannelSlider);
+    detectCountAttach   = std::make_unique<SliderAttachment>(p.apvts, ParameterIDs::detectCount, detectCountSlider);
 
     pitchReadout.setJustificationType(juce::Justification::centred);
     pitchReadout.setFont(juce::FontOptions(20.0f));
     pitchReadout.setText("--", juce::dontSendNotification);
     addAndMakeVisible(pitchReadout);
 
-    setSize(600, 400);
+    loadReadout.setJustificationType(juce::Justification::centred);
+    loadReadout.setFont(juce::FontOptions(13.0f));
+    loadReadout.setColour(juce::Label::textColourId, juce::Colours::grey);
+    addAndMakeVisible(loadReadout);
+
+    setSize(600, 440);
     startTimerHz(30);
 }
 
@@ -63,8 +89,12 @@ HdnRingmodAudioProcessorEditor::~HdnRingmodAudioProcessorEditor()
     manualRateAttach.reset();
     smoothingAttach.reset();
     sensitivityAttach.reset();
+    lookaheadAttach.reset();
+    detectChannelAttach.reset();
+    detectCountAttach.reset();
     modeAttach.reset();
     waveformAttach.reset();
+    detectSourceAttach.reset();
 }
 
 void HdnRingmodAudioProcessorEditor::paint(juce::Graphics& g)
@@ -87,7 +117,7 @@ void HdnRingmodAudioProcessorEditor::resized()
     area.removeFromTop(10);
 
     auto sliderArea = area.removeFromTop(200);
-    int sliderWidth = sliderArea.getWidth() / 5;
+    int sliderWidth = sliderArea.getWidth() / 6;
 
     auto placeSlider = [&](juce::Slider& slider, juce::Label& label)
     {
@@ -101,6 +131,7 @@ void HdnRingmodAudioProcessorEditor::resized()
     placeSlider(manualRateSlider, manualRateLabel);
     placeSlider(smoothingSlider, smoothingLabel);
     placeSlider(sensitivitySlider, sensitivityLabel);
+    placeSlider(lookaheadSlider, lookaheadLabel);
 
     area.removeFromTop(10);
 
@@ -114,6 +145,22 @@ void HdnRingmodAudioProcessorEditor::resized()
     auto rightCombo = comboArea.reduced(10, 0);
     waveformLabel.setBounds(rightCombo.removeFromLeft(80));
     waveformBox.setBounds(rightCombo);
+
+    area.removeFromTop(10);
+
+    auto detectArea = area.removeFromTop(30);
+    auto sourceArea = detectArea.removeFromLeft(comboWidth).reduced(10, 0);
+    detectSourceLabel.setBounds(sourceArea.removeFromLeft(70));
+    detectSourceBox.setBounds(sourceArea);
+
+    auto stepperArea = detectArea.reduced(10, 0);
+    auto channelArea = stepperArea.removeFromLeft(stepperArea.getWidth() / 2);
+    detectChannelLabel.setBounds(channelArea.removeFromLeft(60));
+    detectChannelSlider.setBounds(channelArea);
+    detectCountLabel.setBounds(stepperArea.removeFromLeft(50));
+    detectCountSlider.setBounds(stepperArea);
+
+    loadReadout.setBounds(getLocalBounds().removeFromBottom(24));
 }
 
 void HdnRingmodAudioProcessorEditor::timerCallback()
@@ -131,4 +178,13 @@ void HdnRingmodAudioProcessorEditor::timerCallback()
     {
         pitchReadout.setText("--", juce::dontSendNotification);
     }
+
+    auto load = processorRef.getLoadSnapshot();
+    if (load.numBlocks > 0)
+    {
+        auto percent = [](float x) { return juce::String(x * 100.0f, 1) + "%"; };
+        auto text = "CPU " + percent(load.lastLoad) + "  p99 " + percent(load.p99Load)
+                  + "  max " + percent(load.maxLoad) + "  overruns " + juce::String(static_cast<juce::int64>(load.numOverruns));
+        loadReadout.setText(text, juce::dontSendNotification);
+    }
 }
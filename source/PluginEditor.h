@@ -18,20 +18,25 @@ private:
 
     HdnRingmodAudioProcessor& processorRef;
 
-    juce::Slider mixSlider, rateMultSlider, manualRateSlider, smoothingSlider, sensitivitySlider;
-    juce::Label mixLabel, rateMultLabel, manualRateLabel, smoothingLabel, sensitivityLabel;
+    juce::Slider mixSlider, rateMultSlider, manualRateSlider, smoothingSlider, sensitivitySlider, lookaheadSlider;
+    juce::Label mixLabel, rateMultLabel, manualRateLabel, smoothingLabel, sensitivityLabel, lookaheadLabel;
 
-    juce::ComboBox modeBox, waveformBox;
-    juce::Label modeLabel, waveformLabel;
+    juce::ComboBox modeBox, waveformBox, detectSourceBox;
+    juce::Label modeLabel, waveformLabel, detectSourceLabel;
+
+    juce::Slider detectChannelSlider, detectCountSlider;
+    juce::Label detectChannelLabel, detectCountLabel;
 
     juce::Label pitchReadout;
+    juce::Label loadReadout;
 
     using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
     using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
 
     std::unique_ptr<SliderAttachment> mixAttach, rateMultAttach, manualRateAttach,
-                                       smoothingAttach, sensitivityAttach;
-    std::unique_ptr<ComboBoxAttachment> modeAttach, waveformAttach;
+                                       smoothingAttach, sensitivityAttach, lookaheadAttach,
+                                       detectChannelAttach, detectCountAttach;
+    std::unique_ptr<ComboBoxAttachment> modeAttach, waveformAttach, detectSourceAttach;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HdnRingmodAudioProcessorEditor)
 };
@@ -1,6 +1,8 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "ParameterIDs.h"
+#include "dsp/RingModKernels.h"
+#include <algorithm>
 #include <cmath>
 
 HdnRingmodAudioProcessor::HdnRingmodAudioProcessor()
@@ -16,6 +18,19 @@ HdnRingmodAudioProcessor::HdnRingmodAudioProcessor()
     smoothingParam   = apvts.getRawParameterValue(ParameterIDs::smoothing);
     sensitivityParam = apvts.getRawParameterValue(ParameterIDs::sensitivity);
     waveformParam    = apvts.getRawParameterValue(ParameterIDs::waveform);
+    lookaheadParam   = apvts.getRawParameterValue(ParameterIDs::lookahead);
+    detectSourceParam  = apvts.getRawParameterValue(ParameterIDs::detectSource);
+    detectChannelParam = apvts.getRawParameterValue(ParameterIDs::detectChannel);
+    detectCountParam   = apvts.getRawParameterValue(ParameterIDs::detectCount);
+
+    pitchDetectors.setDifferenceMode(YinPitchDetector::DifferenceMode::CoarseToFine);
+    apvts.addParameterListener(ParameterIDs::lookahead, this);
+}
+
+HdnRingmodAudioProcessor::~HdnRingmodAudioProcessor()
+{
+    apvts.removeParameterListener(ParameterIDs::lookahead, this);
+    cancelPendingUpdate();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout HdnRingmodAudioProcessor::createParameterLayout()
@@ -69,14 +84,56 @@ juce::AudioProcessorValueTreeState::ParameterLayout HdnRingmodAudioProcessor::cr
         juce::StringArray{ "Sine", "Triangle", "Square", "Saw" },
         0));
 
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID(ParameterIDs::lookahead, 1),
+        "Lookahead",
+        juce::NormalisableRange<float>(0.0f, maxLookaheadMs, 0.1f),
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID(ParameterIDs::detectSource, 1),
+        "Detect Source",
+        juce::StringArray{ "Downmix", "Channel", "Channel Range", "Per Channel" },
+        0));
+
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(ParameterIDs::detectChannel, 1),
+        "Detect Channel",
+        1, maxChannels, 1));
+
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID(ParameterIDs::detectCount, 1),
+        "Detect Channel Count",
+        1, maxChannels, 2));
+
     return layout;
 }
 
-void HdnRingmodAudioProcessor::prepareToPlay(double sampleRate, int)
+void HdnRingmodAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    pitchDetector.prepare(sampleRate);
-    oscillator.prepare(sampleRate);
-    pitchSmoother.prepare(sampleRate);
+    auto numChannels = juce::jlimit(1, maxChannels, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+
+    // Offline renders analyse inline so they come out the same every time.
+    pitchDetectors.setSynchronous(isNonRealtime());
+    pitchDetectors.prepare(sampleRate, numChannels);
+
+    blockCapacity = juce::jmax(1, samplesPerBlock);
+    monoBuffer.assign(static_cast<size_t>(blockCapacity), 0.0f);
+    carrierBuffer.assign(static_cast<size_t>(blockCapacity * numChannels), 0.0f);
+    mixBuffer.assign(carrierBuffer.size(), 0.0f);
+
+    chains.resize(static_cast<size_t>(numChannels));
+    for (auto& chain : chains)
+    {
+        chain.oscillator.prepare(sampleRate);
+        chain.smoother.prepare(sampleRate);
+        chain.smoother.setBlockSize(controlBlockSize);
+        chain.provisional.prepare(sampleRate);
+        chain.trackEnable = 0.0f;
+        chain.currentMix = 0.0f;
+        chain.yinLocked = false;
+    }
 
     smoothedMix.reset(sampleRate, 0.02);
     smoothedMix.setCurrentAndTargetValue(mixParam->load() / 100.0f);
@@ -87,35 +144,69 @@ void HdnRingmodAudioProcessor::prepareToPlay(double sampleRate, int)
 
     float tau = 0.005f;
     trackEnableAlpha = 1.0f - std::exp(-1.0f / (static_cast<float>(sampleRate) * tau));
-    smoothedTrackEnable = 0.0f;
+    trackEnableBlockAlpha = 1.0f - std::pow(1.0f - trackEnableAlpha, static_cast<float>(controlBlockSize));
+
+    currentSampleRate = sampleRate;
+    auto maxLookahead = static_cast<int>(std::ceil(maxLookaheadMs * 0.001 * sampleRate));
+    lookaheadDelay.prepare(numChannels, maxLookahead);
+    cancelPendingUpdate();
+    updateLatency();
+    lookaheadDelay.setDelay(lookaheadSamples.load(std::memory_order_relaxed));
+
+    loadMeter.prepare(sampleRate);
 }
 
 void HdnRingmodAudioProcessor::releaseResources()
 {
 }
 
+// Hosts switch this outside processBlock, so the analysis mode is applied here
+// rather than checked on every block.
+void HdnRingmodAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    pitchDetectors.setSynchronous(isNonRealtime);
+}
+
 bool HdnRingmodAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-        && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    auto output = layouts.getMainOutputChannelSet();
+
+    if (output.isDisabled() || output.size() > maxChannels)
         return false;
 
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    if (output != layouts.getMainInputChannelSet())
         return false;
 
     return true;
 }
 
 void HdnRingmodAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+// Hosts with a 64-bit mix engine hand their buffers over as they are. Only the
+// detector works in float, and it narrows its input as it queues it, or inside the
+// downmix when it needs one.
+void HdnRingmodAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+template <typename Sample>
+void HdnRingmodAudioProcessor::processSamples(juce::AudioBuffer<Sample>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
 
     auto numSamples = buffer.getNumSamples();
-    auto numChannels = juce::jmin(buffer.getNumChannels(), 2);
+    auto numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
 
-    if (numChannels == 0 || numSamples == 0)
+    if (numChannels == 0 || numSamples == 0 || chains.empty())
         return;
 
+    BlockLoadMeter::ScopedTimer loadTimer(loadMeter, numSamples);
+
     smoothedMix.setTargetValue(mixParam->load() / 100.0f);
     smoothedRateMult.setTargetValue(rateMultParam->load());
     smoothedManualRate.setTargetValue(manualRateParam->load());
@@ -125,77 +216,360 @@ void HdnRingmodAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
     float sensitivity = sensitivityParam->load() / 100.0f;
     int waveformIdx = static_cast<int>(waveformParam->load());
 
-    pitchSmoother.setSmoothingAmount(smoothing);
-    pitchSmoother.setSensitivity(sensitivity);
-    oscillator.setWaveform(static_cast<Oscillator::Waveform>(waveformIdx));
+    for (auto& chain : chains)
+    {
+        chain.smoother.setSmoothingAmount(smoothing);
+        chain.smoother.setSensitivity(sensitivity);
+        chain.oscillator.setWaveform(static_cast<Oscillator::Waveform>(waveformIdx));
+    }
+
+    bool unlinked = mode == 0
+                 && static_cast<int>(detectSourceParam->load()) == 3
+                 && numChannels <= static_cast<int>(chains.size());
 
-    const float* channelReadPtrs[2] = {};
-    float* channelPtrs[2] = {};
+    Sample* channelPtrs[maxChannels] = {};
     for (int ch = 0; ch < numChannels; ++ch)
-    {
-        channelReadPtrs[ch] = buffer.getReadPointer(ch);
         channelPtrs[ch] = buffer.getWritePointer(ch);
+
+    if (mode == 0)
+        feedPitchDetector(buffer, numChannels, numSamples, unlinked);
+    else
+        parkTrackers();
+
+    // The detector sees the input as it arrives; the audio it modulates is delayed.
+    lookaheadDelay.setDelay(lookaheadSamples.load(std::memory_order_relaxed));
+    lookaheadDelay.process(channelPtrs, numChannels, numSamples);
+
+    // Silence is judged after the delay, so a delayed tail is still modulated.
+    bool silent = true;
+    for (int ch = 0; ch < numChannels && silent; ++ch)
+        silent = RingModKernels::isSilent(channelPtrs[ch], numSamples, static_cast<Sample>(silenceLevel));
+
+    for (int offset = 0; offset < numSamples; offset += blockCapacity)
+    {
+        int count = juce::jmin(blockCapacity, numSamples - offset);
+        Sample* chunkPtrs[maxChannels] = {};
+        for (int ch = 0; ch < numChannels; ++ch)
+            chunkPtrs[ch] = channelPtrs[ch] + offset;
+        renderChunk(chunkPtrs, numChannels, count, mode, unlinked, silent);
     }
 
-    for (int i = 0; i < numSamples; ++i)
+    if (mode == 0)
+    {
+        auto result = pitchDetectors.getResult(0);
+        currentPitchHz.store(result.frequency, std::memory_order_relaxed);
+        currentConfidence.store(result.confidence, std::memory_order_relaxed);
+    }
+    else
+    {
+        currentPitchHz.store(0.0f, std::memory_order_relaxed);
+        currentConfidence.store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+void HdnRingmodAudioProcessor::processBlockBypassed(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    bypassSamples(buffer);
+}
+
+void HdnRingmodAudioProcessor::processBlockBypassed(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    bypassSamples(buffer);
+}
+
+// Bypassed audio still goes through the lookahead delay so the reported latency
+// holds. The detectors are parked and the carriers rest; when processing resumes,
+// the mix ramps in from dry as it does at the start of a note.
+template <typename Sample>
+void HdnRingmodAudioProcessor::bypassSamples(juce::AudioBuffer<Sample>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+
+    parkTrackers();
+
+    for (auto& chain : chains)
+    {
+        chain.trackEnable = 0.0f;
+        chain.currentMix = 0.0f;
+    }
+
+    currentPitchHz.store(0.0f, std::memory_order_relaxed);
+    currentConfidence.store(0.0f, std::memory_order_relaxed);
+
+    lookaheadDelay.setDelay(lookaheadSamples.load(std::memory_order_relaxed));
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    Sample* channelPtrs[maxChannels] = {};
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelPtrs[ch] = buffer.getWritePointer(ch);
+    lookaheadDelay.process(channelPtrs, numChannels, numSamples);
+}
+
+// Lookahead changes can arrive on the audio thread, where the host must not be
+// called, so the new latency is reported from the message thread.
+void HdnRingmodAudioProcessor::parameterChanged(const juce::String&, float)
+{
+    triggerAsyncUpdate();
+}
+
+void HdnRingmodAudioProcessor::handleAsyncUpdate()
+{
+    updateLatency();
+}
+
+// Reports the lookahead to the host for compensation, then hands it to the audio
+// thread, which delays the dry/wet path by it so the carrier meets the audio its
+// pitch was detected from. A change while playing fades across to the new delay.
+void HdnRingmodAudioProcessor::updateLatency()
+{
+    auto samples = juce::roundToInt(lookaheadParam->load() * 0.001 * currentSampleRate);
+    if (samples != getLatencySamples())
+        setLatencySamples(samples);
+    lookaheadSamples.store(samples, std::memory_order_relaxed);
+}
+
+// A silent chunk moves the smoothers, trackers and mix ramps on as usual but renders
+// no carrier and leaves the audio as it is.
+template <typename Sample>
+void HdnRingmodAudioProcessor::renderChunk(Sample* const* channels, int numChannels, int numSamples, int mode,
+                                           bool unlinked, bool silent)
+{
+    int numChains = unlinked ? numChannels : 1;
+
+    for (int offset = 0; offset < numSamples; offset += controlBlockSize)
     {
-        float mix = smoothedMix.getNextValue();
-        float effectiveMix = mix;
+        int count = juce::jmin(controlBlockSize, numSamples - offset);
+        float targetMix = smoothedMix.skip(count);
+        float rate = mode == 0 ? smoothedRateMult.skip(count) : smoothedManualRate.skip(count);
 
-        if (mode == 0)
+        for (int c = 0; c < numChains; ++c)
         {
-            float monoSample = channelReadPtrs[0][i];
-            if (numChannels > 1)
-                monoSample = (monoSample + channelReadPtrs[1][i]) * 0.5f;
+            auto slice = static_cast<size_t>(c * blockCapacity + offset);
+            renderControlBlock(chains[static_cast<size_t>(c)], pitchDetectors.getDetector(c),
+                               silent ? nullptr : carrierBuffer.data() + slice,
+                               silent ? nullptr : mixBuffer.data() + slice, count, mode, targetMix, rate);
+        }
+    }
 
-            pitchDetector.feedSample(monoSample);
+    if (silent)
+        return;
 
-            auto result = pitchDetector.getResult();
-            float smoothedFreq = pitchSmoother.process(result.frequency, result.confidence);
+    if (!unlinked)
+    {
+        // The carrier buffer becomes the gain every channel is scaled by.
+        float* gain = carrierBuffer.data();
+        RingModKernels::ringModGain(gain, mixBuffer.data(), gain, numSamples);
 
-            // Stay dry until the tracker has a pitch, then ramp straight into the tracked carrier.
-            if (smoothedFreq > 0.0f)
-                smoothedTrackEnable += trackEnableAlpha * (1.0f - smoothedTrackEnable);
-            else
-                smoothedTrackEnable = 0.0f;
+        if (RingModKernels::applyGain(channels, numChannels, gain, numSamples))
+            for (int ch = 0; ch < numChannels; ++ch)
+                RingModKernels::zeroNonFinite(channels[ch], numSamples);
+        return;
+    }
 
-            float oscFreq = smoothedFreq * smoothedRateMult.getNextValue();
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto slice = static_cast<size_t>(ch * blockCapacity);
+        float* gain = carrierBuffer.data() + slice;
+        RingModKernels::ringModGain(gain, mixBuffer.data() + slice, gain, numSamples);
 
-            if (oscFreq > 0.0f)
-                oscillator.setFrequency(oscFreq);
+        if (RingModKernels::applyGain(channels[ch], gain, numSamples) != 0)
+            RingModKernels::zeroNonFinite(channels[ch], numSamples);
+    }
+}
 
-            effectiveMix *= smoothedTrackEnable;
+// Detector polling and pitch smoothing run once per control block; the carrier glides
+// to the new frequency and the mix ramps linearly across it. targetMix and rate come
+// from the shared parameter smoothers, advanced once per block by the caller. Null
+// carrier and mix buffers skip the rendering and keep only the state.
+void HdnRingmodAudioProcessor::renderControlBlock(CarrierChain& chain, const YinPitchDetector& detector, float* carrier,
+                                                  float* mixes, int numSamples, int mode, float targetMix, float rate)
+{
+    if (mode == 0)
+    {
+        auto result = detector.getResult();
+        if (chain.smoother.accepts(result.frequency, result.confidence))
+            chain.yinLocked = true;
+        else if (!chain.yinLocked)
+            result = chain.provisional.getResult();
+        float smoothedFreq = chain.smoother.processBlock(result.frequency, result.confidence, numSamples);
+
+        // Stay dry until the tracker has a pitch, then ramp straight into the tracked carrier.
+        if (smoothedFreq > 0.0f)
+        {
+            float blockAlpha = numSamples == controlBlockSize
+                                 ? trackEnableBlockAlpha
+                                 : 1.0f - std::pow(1.0f - trackEnableAlpha, static_cast<float>(numSamples));
+            chain.trackEnable += blockAlpha * (1.0f - chain.trackEnable);
         }
         else
         {
-            smoothedTrackEnable = 1.0f;
-            oscillator.setFrequency(smoothedManualRate.getNextValue());
+            chain.trackEnable = 0.0f;
         }
 
-        float oscSample = oscillator.nextSample();
+        float oscFreq = smoothedFreq * rate;
 
-        for (int ch = 0; ch < numChannels; ++ch)
+        if (carrier == nullptr)
+        {
+            if (oscFreq > 0.0f)
+                chain.oscillator.setFrequency(oscFreq);
+        }
+        else if (oscFreq > 0.0f)
+        {
+            chain.oscillator.renderLogRamp(carrier, numSamples, oscFreq);
+        }
+        else
         {
-            float dry = channelPtrs[ch][i];
-            float wet = dry * oscSample;
-            channelPtrs[ch][i] = dry * (1.0f - effectiveMix) + wet * effectiveMix;
+            chain.oscillator.renderBlock(carrier, numSamples);
+        }
+
+        targetMix *= chain.trackEnable;
+    }
+    else
+    {
+        chain.trackEnable = 1.0f;
+        if (carrier == nullptr)
+            chain.oscillator.setFrequency(rate);
+        else
+            chain.oscillator.renderRamp(carrier, numSamples, rate);
+    }
+
+    if (mixes != nullptr)
+    {
+        float step = (targetMix - chain.currentMix) / static_cast<float>(numSamples);
+        for (int i = 0; i < numSamples; ++i)
+            mixes[i] = chain.currentMix + step * static_cast<float>(i + 1);
+    }
+
+    chain.currentMix = targetMix;
+}
+
+// The channels the detector listens to: all of them, one, or a contiguous range,
+// clamped to the bus.
+int HdnRingmodAudioProcessor::getDetectChannels(int numChannels, int& firstChannel) const
+{
+    int source = static_cast<int>(detectSourceParam->load());
+    if (source != 1 && source != 2)
+    {
+        firstChannel = 0;
+        return numChannels;
+    }
+
+    firstChannel = juce::jlimit(0, numChannels - 1, static_cast<int>(detectChannelParam->load()) - 1);
+    int count = source == 1 ? 1 : static_cast<int>(detectCountParam->load());
+    return juce::jlimit(1, numChannels - firstChannel, count);
+}
+
+template <typename Sample>
+void HdnRingmodAudioProcessor::feedPitchDetector(const juce::AudioBuffer<Sample>& buffer, int numChannels,
+                                                 int numSamples, bool unlinked)
+{
+    auto quiet = static_cast<Sample>(silenceLevel);
 
-            if (!std::isfinite(channelPtrs[ch][i]))
-                channelPtrs[ch][i] = 0.0f;
+    if (unlinked)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            if (RingModKernels::isSilent(buffer.getReadPointer(ch), numSamples, quiet))
+                feedTrackerSilence(ch, numSamples);
+            else
+                feedTracker(ch, buffer.getReadPointer(ch), numSamples);
         }
+        parkTrackers(numChannels);
+        return;
     }
 
-    if (mode == 0)
+    // Linked tracking only feeds the first detector.
+    parkTrackers(1);
+
+    int first = 0;
+    int count = getDetectChannels(numChannels, first);
+
+    bool silent = true;
+    for (int ch = first; ch < first + count && silent; ++ch)
+        silent = RingModKernels::isSilent(buffer.getReadPointer(ch), numSamples, quiet);
+
+    if (silent)
     {
-        auto result = pitchDetector.getResult();
-        currentPitchHz.store(result.frequency, std::memory_order_relaxed);
-        currentConfidence.store(result.confidence, std::memory_order_relaxed);
+        feedTrackerSilence(0, numSamples);
+        return;
     }
-    else
+
+    if (count == 1)
     {
-        currentPitchHz.store(0.0f, std::memory_order_relaxed);
-        currentConfidence.store(0.0f, std::memory_order_relaxed);
+        feedTracker(0, buffer.getReadPointer(first), numSamples);
+        return;
     }
+
+    float* mono = monoBuffer.data();
+    auto capacity = static_cast<int>(monoBuffer.size());
+    if (capacity == 0)
+        return;
+
+    float scale = 1.0f / static_cast<float>(count);
+
+    for (int offset = 0; offset < numSamples; offset += capacity)
+    {
+        int chunk = juce::jmin(capacity, numSamples - offset);
+
+        const Sample* firstIn = buffer.getReadPointer(first, offset);
+        for (int i = 0; i < chunk; ++i)
+            mono[i] = static_cast<float>(firstIn[i]);
+        for (int ch = first + 1; ch < first + count; ++ch)
+        {
+            const Sample* in = buffer.getReadPointer(ch, offset);
+            for (int i = 0; i < chunk; ++i)
+                mono[i] += static_cast<float>(in[i]);
+        }
+        for (int i = 0; i < chunk; ++i)
+            mono[i] *= scale;
+
+        feedTracker(0, mono, chunk);
+    }
+}
+
+// The provisional estimate is only searched for between an onset and YIN's first
+// accepted reading, so a tracked note costs it nothing but the history update. Both
+// take double input as it is and narrow it themselves.
+template <typename Sample>
+void HdnRingmodAudioProcessor::feedTracker(int channel, const Sample* samples, int numSamples)
+{
+    pitchDetectors.feedBlock(channel, samples, numSamples);
+
+    auto& chain = chains[static_cast<size_t>(channel)];
+    auto result = pitchDetectors.getResult(channel);
+    if (chain.smoother.accepts(result.frequency, result.confidence))
+        chain.yinLocked = true;
+    chain.provisional.process(samples, numSamples, !chain.yinLocked);
+}
+
+void HdnRingmodAudioProcessor::feedTrackerSilence(int channel, int numSamples)
+{
+    pitchDetectors.feedSilence(channel, numSamples);
+
+    auto& chain = chains[static_cast<size_t>(channel)];
+    chain.provisional.reset();
+    chain.yinLocked = false;
+}
+
+// Parks every tracker from firstChannel on: all of them when tracking stops, or
+// the ones linked tracking leaves unused.
+void HdnRingmodAudioProcessor::parkTrackers(int firstChannel)
+{
+    pitchDetectors.park(firstChannel);
+    for (size_t ch = static_cast<size_t>(firstChannel); ch < chains.size(); ++ch)
+    {
+        chains[ch].provisional.reset();
+        chains[ch].yinLocked = false;
+    }
+}
+
+PitchDetectorTelemetry HdnRingmodAudioProcessor::getDetectorTelemetry() const
+{
+    return pitchDetectors.getTelemetry();
 }
 
 juce::AudioProcessorEditor* HdnRingmodAudioProcessor::createEditor()
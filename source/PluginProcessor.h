@@ -1,23 +1,34 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
-#include "dsp/YinPitchDetector.h"
+#include "dsp/PitchDetectorGroup.h"
 #include "dsp/Oscillator.h"
 #include "dsp/PitchSmoother.h"
+#include "dsp/ProvisionalPitchEstimator.h"
+#include "dsp/LookaheadDelay.h"
+#include "dsp/BlockLoadMeter.h"
 #include <atomic>
+#include <vector>
 
-class HdnRingmodAudioProcessor : public juce::AudioProcessor
+class HdnRingmodAudioProcessor : public juce::AudioProcessor,
+                                 private juce::AudioProcessorValueTreeState::Listener,
+                                 private juce::AsyncUpdater
 {
 public:
     HdnRingmodAudioProcessor();
-    ~HdnRingmodAudioProcessor() override = default;
+    ~HdnRingmodAudioProcessor() override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+    void processBlockBypassed(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -40,22 +51,86 @@ public:
 
     juce::AudioProcessorValueTreeState apvts;
 
+    static constexpr int maxChannels = 16;
+
+    // The tracked pitch for the display. In Per Channel mode, the first channel's.
     std::atomic<float> currentPitchHz { 0.0f };
     std::atomic<float> currentConfidence { 0.0f };
 
+    // Audio-thread load per block; safe to call from any thread.
+    BlockLoadMeter::Snapshot getLoadSnapshot() const { return loadMeter.getSnapshot(); }
+    void resetLoadStats() { loadMeter.reset(); }
+    // Over every channel's detector; see PitchDetectorGroup::getTelemetry().
+    PitchDetectorTelemetry getDetectorTelemetry() const;
+
 private:
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    YinPitchDetector pitchDetector;
-    Oscillator oscillator;
-    PitchSmoother pitchSmoother;
+    // Pitch smoothing, provisional pitch, carrier and dry/wet ramp for one tracked
+    // signal: the selected detect source, or one channel in Per Channel mode.
+    struct CarrierChain
+    {
+        PitchSmoother smoother;
+        ProvisionalPitchEstimator provisional;
+        Oscillator oscillator;
+        float trackEnable = 0.0f;
+        float currentMix = 0.0f;
+
+        // Set once the smoother accepts a YIN reading, cleared by silence or a park.
+        // Until then the provisional estimate fills in; after, a rejected reading
+        // holds the last pitch.
+        bool yinLocked = false;
+    };
+
+    // Float and double hosts share one implementation, instantiated for each in the .cpp.
+    template <typename Sample>
+    void processSamples(juce::AudioBuffer<Sample>& buffer);
+    template <typename Sample>
+    void bypassSamples(juce::AudioBuffer<Sample>& buffer);
+    template <typename Sample>
+    void feedPitchDetector(const juce::AudioBuffer<Sample>& buffer, int numChannels, int numSamples, bool unlinked);
+    template <typename Sample>
+    void feedTracker(int channel, const Sample* samples, int numSamples);
+    void feedTrackerSilence(int channel, int numSamples);
+    void parkTrackers(int firstChannel = 0);
+    template <typename Sample>
+    void renderChunk(Sample* const* channels, int numChannels, int numSamples, int mode, bool unlinked, bool silent);
+    void renderControlBlock(CarrierChain& chain, const YinPitchDetector& detector, float* carrier, float* mixes,
+                            int numSamples, int mode, float targetMix, float rate);
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void updateLatency();
+    int getDetectChannels(int numChannels, int& firstChannel) const;
+
+    static constexpr int controlBlockSize = 32;
+    static constexpr float maxLookaheadMs = 40.0f;
+
+    // Blocks no louder than this (-120 dBFS) skip the detector and carrier; they are
+    // passed through unmodulated.
+    static constexpr float silenceLevel = 1.0e-6f;
+
+    PitchDetectorGroup pitchDetectors;
+    std::vector<CarrierChain> chains;
+    LookaheadDelay lookaheadDelay;
+    BlockLoadMeter loadMeter;
+
+    // Carrier and mix hold one blockCapacity-long slice per chain.
+    std::vector<float> monoBuffer;
+    std::vector<float> carrierBuffer;
+    std::vector<float> mixBuffer;
+    int blockCapacity = 0;
 
     juce::SmoothedValue<float> smoothedMix;
     juce::SmoothedValue<float> smoothedRateMult;
     juce::SmoothedValue<float> smoothedManualRate;
 
-    float smoothedTrackEnable = 1.0f;
     float trackEnableAlpha = 0.01f;
+    float trackEnableBlockAlpha = 0.01f;
+
+    // The lookahead in samples, as last reported to the host. Written on the message
+    // thread, read by the audio thread.
+    std::atomic<int> lookaheadSamples { 0 };
+    double currentSampleRate = 44100.0;
 
     std::atomic<float>* mixParam = nullptr;
     std::atomic<float>* rateMultParam = nullptr;
@@ -64,6 +139,10 @@ private:
     std::atomic<float>* smoothingParam = nullptr;
     std::atomic<float>* sensitivityParam = nullptr;
     std::atomic<float>* waveformParam = nullptr;
+    std::atomic<float>* lookaheadParam = nullptr;
+    std::atomic<float>* detectSourceParam = nullptr;
+    std::atomic<float>* detectChannelParam = nullptr;
+    std::atomic<float>* detectCountParam = nullptr;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(HdnRingmodAudioProcessor)
 };
@@ -0,0 +1,192 @@
+#include "AnalysisThreadPool.h"
+#include <thread>
+
+class AnalysisThreadPool::Worker : public juce::Thread
+{
+public:
+    Worker(AnalysisThreadPool& owner, int workerIndex)
+        : Thread("PitchAnalysis"), pool(owner), index(workerIndex) {}
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            pool.pendingJobs.acquire();
+            if (threadShouldExit())
+                break;
+
+            if (auto* job = pool.take(index))
+                pool.execute(*job);
+        }
+    }
+
+private:
+    AnalysisThreadPool& pool;
+    int index;
+};
+
+AnalysisThreadPool::JobQueue::JobQueue()
+{
+    for (size_t i = 0; i < capacity; ++i)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool AnalysisThreadPool::JobQueue::push(Job* job)
+{
+    auto pos = tail.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[pos & mask];
+        auto seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0)
+        {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                cell.job = job;
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+AnalysisThreadPool::Job* AnalysisThreadPool::JobQueue::pop()
+{
+    auto pos = head.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        auto& cell = cells[pos & mask];
+        auto seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+        if (diff == 0)
+        {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                auto* job = cell.job;
+                cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                return job;
+            }
+        }
+        else if (diff < 0)
+        {
+            return nullptr;
+        }
+        else
+        {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+AnalysisThreadPool::AnalysisThreadPool()
+{
+    int numWorkers = juce::jmax(1, juce::SystemStats::getNumCpus());
+
+    for (int i = 0; i < numWorkers; ++i)
+        queues.push_back(std::make_unique<JobQueue>());
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>(*this, i));
+        workers.back()->startThread(juce::Thread::Priority::normal);
+    }
+}
+
+AnalysisThreadPool::~AnalysisThreadPool()
+{
+    for (auto& worker : workers)
+        worker->signalThreadShouldExit();
+
+    pendingJobs.release(static_cast<std::ptrdiff_t>(workers.size()));
+
+    for (auto& worker : workers)
+        worker->stopThread(1000);
+}
+
+bool AnalysisThreadPool::submit(Job& job)
+{
+    // Pairs with the fence in execute(): either this sees the worker's cleared flag,
+    // or the worker's hasPendingWork() sees the input written before this call.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (job.suspended.load() || job.scheduled.load())
+        return false;
+
+    if (job.scheduled.exchange(true))
+        return false;
+
+    auto numQueues = static_cast<uint32_t>(queues.size());
+    auto first = nextQueue.fetch_add(1, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < numQueues; ++i)
+    {
+        if (queues[(first + i) % numQueues]->push(&job))
+        {
+            pendingJobs.release();
+            return true;
+        }
+    }
+
+    job.scheduled.store(false);
+    return false;
+}
+
+void AnalysisThreadPool::suspend(Job& job)
+{
+    job.suspended.store(true);
+
+    while (!job.isIdle())
+        std::this_thread::yield();
+}
+
+void AnalysisThreadPool::resume(Job& job)
+{
+    job.suspended.store(false);
+
+    if (job.hasPendingWork())
+        submit(job);
+}
+
+AnalysisThreadPool::Job* AnalysisThreadPool::take(int workerIndex)
+{
+    auto numQueues = static_cast<int>(queues.size());
+
+    // Every acquired token is backed by a queued job; keep stealing until it turns up.
+    for (;;)
+    {
+        for (int i = 0; i < numQueues; ++i)
+            if (auto* job = queues[static_cast<size_t>((workerIndex + i) % numQueues)]->pop())
+                return job;
+
+        std::this_thread::yield();
+    }
+}
+
+void AnalysisThreadPool::execute(Job& job)
+{
+    ++job.running;
+
+    if (!job.suspended.load())
+        job.run();
+
+    job.scheduled.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (!job.suspended.load() && job.hasPendingWork())
+        submit(job);
+
+    --job.running;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <semaphore>
+#include <vector>
+
+// Process-wide pool of analysis workers shared by every pitch detector. Obtain it
+// through juce::SharedResourcePointer so all plugin instances use the same threads.
+class AnalysisThreadPool
+{
+public:
+    class Job
+    {
+    public:
+        virtual ~Job() = default;
+
+        virtual void run() = 0;
+        virtual bool hasPendingWork() const = 0;
+
+        bool isIdle() const
+        {
+            return !scheduled.load() && running.load() == 0;
+        }
+
+    private:
+        friend class AnalysisThreadPool;
+
+        std::atomic<bool> scheduled { false };
+        std::atomic<int> running { 0 };
+        std::atomic<bool> suspended { false };
+    };
+
+    AnalysisThreadPool();
+    ~AnalysisThreadPool();
+
+    // Realtime-safe: no locks or allocation. Returns false if the job is already
+    // queued or running, is suspended, or every queue is full.
+    bool submit(Job& job);
+
+    // Blocks until the job is neither queued nor running and rejects further submits.
+    void suspend(Job& job);
+    void resume(Job& job);
+
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+private:
+    class JobQueue
+    {
+    public:
+        JobQueue();
+
+        bool push(Job* job);
+        Job* pop();
+
+    private:
+        static constexpr size_t capacity = 512;
+        static constexpr size_t mask = capacity - 1;
+
+        struct Cell
+        {
+            std::atomic<size_t> sequence { 0 };
+            Job* job = nullptr;
+        };
+
+        std::array<Cell, capacity> cells;
+        alignas(64) std::atomic<size_t> head { 0 };
+        alignas(64) std::atomic<size_t> tail { 0 };
+    };
+
+    class Worker;
+
+    Job* take(int workerIndex);
+    void execute(Job& job);
+
+    std::vector<std::unique_ptr<JobQueue>> queues;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::counting_semaphore<> pendingJobs { 0 };
+    std::atomic<uint32_t> nextQueue { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(AnalysisThreadPool)
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "FastMath.h"
+
+// Per-block processing time as a fraction of the block's real duration. The audio
+// thread is the only writer and never blocks; any thread can take a consistent
+// snapshot, which retries if it overlaps a write.
+class BlockLoadMeter
+{
+public:
+    // Log-spaced bins, 8 per octave from 0.1% up to ~370% load.
+    static constexpr int numBins = 96;
+    static constexpr int binsPerOctave = 8;
+    static constexpr float minLoad = 1.0f / 1024.0f;
+
+    struct Snapshot
+    {
+        std::array<uint32_t, numBins> histogram {};
+        uint64_t numBlocks = 0;
+        uint64_t numOverruns = 0; // blocks that took longer than their own duration
+        float lastLoad = 0.0f;
+        float meanLoad = 0.0f;
+        float maxLoad = 0.0f;
+        float p99Load = 0.0f;     // upper edge of the bin holding the 99th percentile
+    };
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(BlockLoadMeter& m, int samples)
+            : meter(m), numSamples(samples), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedTimer()
+        {
+            meter.recordTicks(juce::Time::getHighResolutionTicks() - start, numSamples);
+        }
+
+    private:
+        BlockLoadMeter& meter;
+        int numSamples;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    void prepare(double sampleRate)
+    {
+        // Folds the tick rate and sample rate into one multiply per block.
+        loadPerTickSample = sampleRate / static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+        resetRequested.store(true, std::memory_order_relaxed);
+    }
+
+    // Safe from any thread; the audio thread clears the stats before its next block.
+    void reset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    void recordTicks(juce::int64 ticks, int numSamples)
+    {
+        if (numSamples > 0)
+            recordLoad(static_cast<float>(static_cast<double>(ticks) * loadPerTickSample / numSamples));
+    }
+
+    void recordLoad(float load)
+    {
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (resetRequested.load(std::memory_order_relaxed))
+        {
+            resetRequested.store(false, std::memory_order_relaxed);
+            clear();
+        }
+
+        auto& bin = bins[static_cast<size_t>(binFor(load))];
+        bin.store(bin.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        blocks.store(blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (load > 1.0f)
+            overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        loadSum.store(loadSum.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+        maxLoad.store(std::max(maxLoad.load(std::memory_order_relaxed), load), std::memory_order_relaxed);
+        lastLoad.store(load, std::memory_order_relaxed);
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    Snapshot getSnapshot() const
+    {
+        Snapshot s;
+        double sum = 0.0;
+
+        for (;;)
+        {
+            auto before = sequence.load(std::memory_order_acquire);
+            if ((before & 1u) == 0)
+            {
+                for (int i = 0; i < numBins; ++i)
+                    s.histogram[static_cast<size_t>(i)] = bins[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+                s.numBlocks = blocks.load(std::memory_order_relaxed);
+                s.numOverruns = overruns.load(std::memory_order_relaxed);
+                s.lastLoad = lastLoad.load(std::memory_order_relaxed);
+                s.maxLoad = maxLoad.load(std::memory_order_relaxed);
+                sum = loadSum.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    break;
+            }
+            juce::Thread::yield();
+        }
+
+        if (s.numBlocks > 0)
+        {
+            s.meanLoad = static_cast<float>(sum / static_cast<double>(s.numBlocks));
+
+            auto target = s.numBlocks - s.numBlocks / 100;
+            uint64_t seen = 0;
+            for (int i = 0; i < numBins; ++i)
+            {
+                seen += s.histogram[static_cast<size_t>(i)];
+                if (seen >= target)
+                {
+                    s.p99Load = std::min(binUpperEdge(i), s.maxLoad);
+                    break;
+                }
+            }
+        }
+
+        return s;
+    }
+
+    static int binFor(float load)
+    {
+        if (!(load > minLoad))
+            return 0;
+        auto index = static_cast<int>(binsPerOctave * FastMath::log2Approx(load / minLoad));
+        return std::min(index, numBins - 1);
+    }
+
+    static float binLowerEdge(int bin)
+    {
+        return bin == 0 ? 0.0f : minLoad * std::exp2(static_cast<float>(bin) / binsPerOctave);
+    }
+
+    static float binUpperEdge(int bin)
+    {
+        return minLoad * std::exp2(static_cast<float>(bin + 1) / binsPerOctave);
+    }
+
+private:
+    void clear()
+    {
+        for (auto& bin : bins)
+            bin.store(0, std::memory_order_relaxed);
+        blocks.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+        loadSum.store(0.0, std::memory_order_relaxed);
+        maxLoad.store(0.0f, std::memory_order_relaxed);
+        lastLoad.store(0.0f, std::memory_order_relaxed);
+    }
+
+    double loadPerTickSample = 44100.0 / 1.0e9;
+
+    std::atomic<uint32_t> sequence { 0 };
+    std::atomic<bool> resetRequested { false };
+    std::array<std::atomic<uint32_t>, numBins> bins {};
+    std::atomic<uint64_t> blocks { 0 };
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<double> loadSum { 0.0 };
+    std::atomic<float> maxLoad { 0.0f };
+    std::atomic<float> lastLoad { 0.0f };
+};
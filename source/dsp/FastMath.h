@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+// HDN_FAST_MATH selects the polynomial log2/exp2 below for the pitch path; with it
+// off, FastMath::log2/exp2 forward to the standard library.
+#ifndef HDN_FAST_MATH
+ #define HDN_FAST_MATH 1
+#endif
+
+namespace FastMath
+{
+    // log2 of a positive, normal float: exponent from the bits plus a degree-5
+    // minimax polynomial on the mantissa. Max error 1.5e-5 (0.02 cents).
+    inline float log2Approx(float x)
+    {
+        auto bits = std::bit_cast<uint32_t>(x);
+        auto exponent = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+        float t = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u) - 1.0f;
+
+        float p = 0.0463851232f;
+        p = p * t - 0.196269061f;
+        p = p * t + 0.417595302f;
+        p = p * t - 0.709662662f;
+        p = p * t + 1.4419656f;
+        return exponent + p * t;
+    }
+
+    // 2^x for x in [-126, 128): integer part into the exponent bits, degree-4
+    // minimax polynomial for the fraction. Max relative error 4.2e-6 (0.01 cents).
+    inline float exp2InRange(float x)
+    {
+        // Biased so truncation is floor; the bias is also the exponent offset.
+        auto biased = static_cast<int32_t>(x + 127.0f);
+        float t = x - static_cast<float>(biased - 127);
+
+        float p = 0.0135812492f;
+        p = p * t + 0.0519505461f;
+        p = p * t + 0.241445507f;
+        p = p * t + 0.693018529f;
+        p = p * t + 1.0f;
+
+        return p * std::bit_cast<float>(static_cast<uint32_t>(biased) << 23);
+    }
+
+    inline float clampExponent(float x)
+    {
+        return std::min(std::max(x, -126.0f), 127.0f);
+    }
+
+    inline float exp2Approx(float x)
+    {
+        return exp2InRange(clampExponent(x));
+    }
+
+    // Block forms for control-rate paths. The clamp gets its own pass: fused, the
+    // compiler threads the clamped cases past the polynomial and stops vectorising.
+    inline void log2Approx(const float* in, float* out, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            out[i] = log2Approx(in[i]);
+    }
+
+    inline void exp2Approx(const float* in, float* out, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            out[i] = clampExponent(in[i]);
+
+        for (int i = 0; i < numSamples; ++i)
+            out[i] = exp2InRange(out[i]);
+    }
+
+    inline float log2(float x)
+    {
+        if constexpr (HDN_FAST_MATH != 0)
+            return log2Approx(x);
+        else
+            return std::log2(x);
+    }
+
+    inline float exp2(float x)
+    {
+        if constexpr (HDN_FAST_MATH != 0)
+            return exp2Approx(x);
+        else
+            return std::exp2(x);
+    }
+}
@@ -1,41 +1,145 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 
+// 2:1 halfband decimator in polyphase form. Every other tap of a halfband filter is
+// zero, so the odd-phase branch is just the 0.5 centre tap and the even-phase branch
+// holds the remaining symmetric taps, which are folded so each pair costs one multiply.
 class HalfbandDecimator
 {
 public:
+    enum class Design
+    {
+        Compact, // 7 taps, cheapest, ~19 dB rejection at 0.35 fs
+        Steep    // 31 taps, Kaiser (beta 8), ~85 dB rejection from 0.35 fs
+    };
+
+    void setDesign(Design newDesign)
+    {
+        design = newDesign;
+        reset();
+    }
+
+    Design getDesign() const { return design; }
+
     void reset()
     {
-        delayLine.fill(0.0f);
+        evenHistory.fill(0.0f);
+        oddHistory.fill(0.0f);
+        pendingInput = 0.0f;
+        lastOutput = 0.0f;
         phase = 0;
     }
 
     bool processSample(float input)
     {
-        for (int i = numTaps - 1; i > 0; --i)
-            delayLine[static_cast<size_t>(i)] = delayLine[static_cast<size_t>(i - 1)];
-        delayLine[0] = input;
+        float output = 0.0f;
+        if (process(&input, 1, &output) == 0)
+            return false;
+
+        lastOutput = output;
+        return true;
+    }
+
+    // Decimates numSamples inputs into out and returns the number of outputs written:
+    // (numSamples + getPhase()) / 2. Input and output may not overlap.
+    int process(const float* in, int numSamples, float* out)
+    {
+        if (numSamples <= 0)
+            return 0;
+
+        int produced = 0;
+        int i = 0;
 
-        if (++phase >= 2)
+        while (i < numSamples)
         {
-            phase = 0;
-            lastOutput = 0.0f;
-            for (int i = 0; i < numTaps; ++i)
-                lastOutput += coeffs[static_cast<size_t>(i)] * delayLine[static_cast<size_t>(i)];
-            return true;
+            if (design == Design::Steep)
+                produced += processChunk<steepCoeffs.size()>(steepCoeffs, in, numSamples, i, out + produced);
+            else
+                produced += processChunk<compactCoeffs.size()>(compactCoeffs, in, numSamples, i, out + produced);
         }
-        return false;
+
+        if (produced > 0)
+            lastOutput = out[produced - 1];
+
+        return produced;
     }
 
     float getOutput() const { return lastOutput; }
+    int getPhase() const { return phase; }
 
 private:
-    static constexpr int numTaps = 7;
-    static constexpr std::array<float, 7> coeffs = {
-        -0.03125f, 0.0f, 0.28125f, 0.5f, 0.28125f, 0.0f, -0.03125f
+    static constexpr int chunkSize = 64;
+    static constexpr size_t maxSideTaps = 8;
+
+    // First half of the even-phase taps; the second half mirrors them.
+    static constexpr std::array<float, 2> compactCoeffs = {
+        -0.03125f, 0.28125f
+    };
+    static constexpr std::array<float, maxSideTaps> steepCoeffs = {
+        -4.96282324e-05f, 0.000642232722f, -0.00273435072f, 0.00802005798f,
+        -0.0192270002f, 0.0415353269f, -0.0912217822f, 0.313035144f
     };
-    std::array<float, 7> delayLine {};
+
+    template <size_t numSideTaps>
+    int processChunk(const std::array<float, numSideTaps>& coeffs, const float* in, int numSamples, int& i, float* out)
+    {
+        constexpr int evenLength = 2 * static_cast<int>(numSideTaps) - 1;
+        constexpr int oddLength = static_cast<int>(numSideTaps) - 1;
+
+        std::array<float, evenLength + chunkSize> even;
+        std::array<float, oddLength + chunkSize> odd;
+        std::copy_n(evenHistory.begin(), evenLength, even.begin());
+        std::copy_n(oddHistory.begin(), oddLength, odd.begin());
+
+        int pairs = 0;
+
+        if (phase == 1)
+        {
+            odd[oddLength] = pendingInput;
+            even[evenLength] = in[i++];
+            phase = 0;
+            pairs = 1;
+        }
+
+        int available = std::min(chunkSize - pairs, (numSamples - i) / 2);
+        for (int p = 0; p < available; ++p)
+        {
+            odd[static_cast<size_t>(oddLength + pairs + p)] = in[i + 2 * p];
+            even[static_cast<size_t>(evenLength + pairs + p)] = in[i + 2 * p + 1];
+        }
+        i += 2 * available;
+        pairs += available;
+
+        if (pairs < chunkSize && i < numSamples)
+        {
+            pendingInput = in[i++];
+            phase = 1;
+        }
+
+        for (int m = 0; m < pairs; ++m)
+            out[m] = 0.5f * odd[static_cast<size_t>(m)];
+
+        for (size_t k = 0; k < numSideTaps; ++k)
+        {
+            const float c = coeffs[k];
+            const float* newer = even.data() + evenLength - static_cast<int>(k);
+            const float* older = even.data() + k;
+            for (int m = 0; m < pairs; ++m)
+                out[m] += c * (newer[m] + older[m]);
+        }
+
+        std::copy_n(even.begin() + pairs, evenLength, evenHistory.begin());
+        std::copy_n(odd.begin() + pairs, oddLength, oddHistory.begin());
+
+        return pairs;
+    }
+
+    std::array<float, 2 * maxSideTaps - 1> evenHistory {};
+    std::array<float, maxSideTaps - 1> oddHistory {};
+    float pendingInput = 0.0f;
     float lastOutput = 0.0f;
     int phase = 0;
+    Design design = Design::Compact;
 };
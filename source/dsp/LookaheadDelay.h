@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Multichannel delay for the dry/wet path, so the carrier can be lined up with the
+// audio the detector has already analysed. Works on whole blocks in place. The
+// history is kept in double so float and double hosts share one delay line losslessly.
+class LookaheadDelay
+{
+public:
+    void prepare(int numChannels, int maxDelaySamples)
+    {
+        maxDelay = std::max(0, maxDelaySamples);
+        ringSize = maxDelay + blockLimit;
+        rings.assign(static_cast<size_t>(std::max(0, numChannels)), std::vector<double>(static_cast<size_t>(ringSize), 0.0));
+        target = std::min(target, maxDelay);
+        delay = target;
+        writePos = 0;
+        running = false;
+        fadeRemaining = 0;
+    }
+
+    void reset()
+    {
+        for (auto& ring : rings)
+            std::fill(ring.begin(), ring.end(), 0.0);
+        delay = target;
+        writePos = 0;
+        running = false;
+        fadeRemaining = 0;
+    }
+
+    // Clamped to the prepared maximum. Before any audio has gone through, the new
+    // delay applies at once; after that the history is kept and the output
+    // crossfades from the old read position to the new one over fadeSamples, so a
+    // change neither clicks nor drops out. A change during a fade waits for it to
+    // finish, as the output is then between two positions and cannot jump to a third.
+    void setDelay(int samples)
+    {
+        target = std::clamp(samples, 0, maxDelay);
+        if (!running)
+            delay = target;
+    }
+
+    // The delay last set, which the output may still be fading towards.
+    int getDelay() const { return target; }
+    int getMaxDelay() const { return maxDelay; }
+
+    // Replaces each channel with its input from getDelay() samples ago. Channels past
+    // the prepared count are left untouched. At zero delay the audio is left as it is,
+    // but still recorded, so a later change has history to fade into.
+    template <typename Sample>
+    void process(Sample* const* channels, int numChannels, int numSamples)
+    {
+        numChannels = std::min(numChannels, static_cast<int>(rings.size()));
+        running = true;
+
+        for (int offset = 0; offset < numSamples; offset += blockLimit)
+        {
+            int count = std::min(blockLimit, numSamples - offset);
+
+            if (fadeRemaining == 0 && delay != target)
+            {
+                fadeFrom = delay;
+                fadeRemaining = fadeSamples;
+                delay = target;
+            }
+
+            int readPos = writePos - delay;
+            if (readPos < 0)
+                readPos += ringSize;
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                Sample* data = channels[ch] + offset;
+                auto& ring = rings[static_cast<size_t>(ch)];
+                copyIn(ring, writePos, data, count);
+
+                if (fadeRemaining > 0)
+                    crossfadeOut(ring, data, count);
+                else if (delay > 0)
+                    copyOut(ring, readPos, data, count);
+            }
+
+            if (fadeRemaining > 0)
+                fadeRemaining -= std::min(count, fadeRemaining);
+
+            writePos += count;
+            if (writePos >= ringSize)
+                writePos -= ringSize;
+        }
+    }
+
+    static constexpr int fadeSamples = 256;
+
+private:
+    // The ring holds maxDelay samples of history plus one block, so a block can be
+    // written before the delayed block is read back without overwriting it.
+    static constexpr int blockLimit = 512;
+
+    // Reads the block at both delays and moves linearly from the old one to the new.
+    template <typename Sample>
+    void crossfadeOut(const std::vector<double>& ring, Sample* out, int count) const
+    {
+        auto wrap = [this](int pos) { return pos < 0 ? pos + ringSize : pos >= ringSize ? pos - ringSize : pos; };
+        int faded = fadeSamples - fadeRemaining;
+
+        for (int i = 0; i < count; ++i)
+        {
+            double from = ring[static_cast<size_t>(wrap(writePos - fadeFrom + i))];
+            double to = ring[static_cast<size_t>(wrap(writePos - delay + i))];
+            double gain = std::min(1.0, static_cast<double>(faded + i + 1) / fadeSamples);
+            out[i] = static_cast<Sample>(from + gain * (to - from));
+        }
+    }
+
+    template <typename Sample>
+    void copyIn(std::vector<double>& ring, int pos, const Sample* in, int count) const
+    {
+        int first = std::min(count, ringSize - pos);
+        std::copy_n(in, first, ring.data() + pos);
+        std::copy_n(in + first, count - first, ring.data());
+    }
+
+    template <typename Sample>
+    void copyOut(const std::vector<double>& ring, int pos, Sample* out, int count) const
+    {
+        int first = std::min(count, ringSize - pos);
+        std::transform(ring.data() + pos, ring.data() + pos + first, out, [](double x) { return static_cast<Sample>(x); });
+        std::transform(ring.data(), ring.data() + count - first, out + first, [](double x) { return static_cast<Sample>(x); });
+    }
+
+    std::vector<std::vector<double>> rings;
+    int maxDelay = 0;
+    int ringSize = 0;
+    int target = 0;
+    int delay = 0;
+    int writePos = 0;
+    bool running = false;
+    int fadeFrom = 0;
+    int fadeRemaining = 0;
+};
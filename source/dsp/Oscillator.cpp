@@ -1,28 +1,138 @@
 #include "Oscillator.h"
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 static constexpr double twoPi = 6.283185307179586476925;
 
+static constexpr int tableSize = 2048;
+
 static const float* getSineTable()
 {
-    static constexpr int size = 2048;
     static const auto table = [] {
-        std::array<float, size + 1> t {};
-        for (int i = 0; i <= size; ++i)
-            t[static_cast<size_t>(i)] = static_cast<float>(std::sin(twoPi * static_cast<double>(i) / size));
+        std::array<float, tableSize + 1> t {};
+        for (int i = 0; i <= tableSize; ++i)
+            t[static_cast<size_t>(i)] = static_cast<float>(std::sin(twoPi * static_cast<double>(i) / tableSize));
         return t;
     }();
     return table.data();
 }
 
+// Band-limited triangle, square and saw, one table per octave. Table j holds
+// harmonics 1 to 512 >> j and the last one is silent. A phase increment in octave j
+// (dt * tableSize in [2^j, 2^(j+1))) crossfades tables j and j + 1, whose top
+// harmonics stay below Nyquist across the whole octave.
+struct Wavetables
+{
+    static constexpr int numLevels = 11;
+    static constexpr int stride = 2 * (tableSize + 1);
+
+    static size_t start(Oscillator::Waveform shape)
+    {
+        return (static_cast<size_t>(shape) - 1) * numLevels * stride;
+    }
+
+    std::array<float, 3 * numLevels * stride> data;
+};
+
+static const Wavetables& getWavetables()
+{
+    static const auto tables = [] {
+        constexpr double pi = twoPi / 2.0;
+        auto t = std::make_unique<Wavetables>();
+
+        std::array<double, tableSize> sine {}, cosine {};
+        for (int i = 0; i < tableSize; ++i)
+        {
+            sine[static_cast<size_t>(i)] = std::sin(twoPi * i / tableSize);
+            cosine[static_cast<size_t>(i)] = std::cos(twoPi * i / tableSize);
+        }
+
+        for (auto shape : { Oscillator::Waveform::Triangle, Oscillator::Waveform::Square, Oscillator::Waveform::Saw })
+        {
+            // Fourier series of the naive shapes: the triangle starts at +1, the square
+            // is high for the first half cycle and the saw rises from -1.
+            auto addHarmonic = [&](std::vector<double>& sum, int h) {
+                bool odd = h % 2 == 1;
+                for (size_t i = 0; i < tableSize; ++i)
+                {
+                    auto k = (static_cast<size_t>(h) * i) & (tableSize - 1);
+                    if (shape == Oscillator::Waveform::Triangle && odd)
+                        sum[i] += 8.0 / (pi * pi * h * h) * cosine[k];
+                    else if (shape == Oscillator::Waveform::Square && odd)
+                        sum[i] += 4.0 / (pi * h) * sine[k];
+                    else if (shape == Oscillator::Waveform::Saw)
+                        sum[i] -= 2.0 / (pi * h) * sine[k];
+                }
+            };
+
+            float* levels = t->data.data() + Wavetables::start(shape);
+            std::vector<double> sum(tableSize, 0.0);
+            int harmonics = 0;
+            double peak = 0.0;
+
+            // Top level down, each adding the harmonics the one above lacks.
+            for (int level = Wavetables::numLevels - 1; level >= 0; --level)
+            {
+                int top = level == Wavetables::numLevels - 1 ? 0 : (tableSize / 4) >> level;
+                for (; harmonics < top; ++harmonics)
+                    addHarmonic(sum, harmonics + 1);
+
+                // Each entry pairs a sample with its difference to the level above,
+                // so the crossfade reads one run of four floats.
+                float* table = levels + level * Wavetables::stride;
+                const float* above = level == Wavetables::numLevels - 1 ? nullptr : table + Wavetables::stride;
+                for (int i = 0; i <= tableSize; ++i)
+                {
+                    double x = sum[static_cast<size_t>(i % tableSize)];
+                    auto value = static_cast<float>(x);
+                    table[2 * i] = value;
+                    table[2 * i + 1] = above != nullptr ? above[2 * i] - value : -value;
+                    peak = std::max(peak, std::abs(x));
+                }
+            }
+
+            // One gain per shape keeps the fundamental level across octaves and the
+            // Gibbs overshoot inside [-1, 1].
+            auto gain = static_cast<float>(1.0 / std::max(1.0, peak));
+            for (int i = 0; i < Wavetables::numLevels * Wavetables::stride; ++i)
+                levels[i] *= gain;
+        }
+
+        return t;
+    }();
+    return *tables;
+}
+
 void Oscillator::prepare(double sampleRate)
 {
+    // Building the wavetables takes milliseconds, too long for the first audio block.
+    getSineTable();
+    getWavetables();
+
     sr = std::max(1.0, sampleRate);
     phase = 0.0;
+    fixedPhase = 0;
     updateIncrement();
 }
 
+void Oscillator::setFixedPointPhase(bool shouldUseFixedPoint)
+{
+    if (fixedPointPhase == shouldUseFixedPoint)
+        return;
+
+    fixedPointPhase = shouldUseFixedPoint;
+
+    if (fixedPointPhase)
+        fixedPhase = toFixed(phase);
+    else
+        phase = static_cast<double>(fixedPhase) / fixedOne;
+}
+
 void Oscillator::setFrequency(float hz)
 {
     if (hz == freq)
@@ -36,59 +146,205 @@ void Oscillator::setWaveform(Waveform w)
     waveform = w;
 }
 
-double Oscillator::polyBLEP(double t, double dt)
+// Rounded to the nearest step; the cast to uint32_t wraps negative and multi-cycle
+// increments the same way the phase itself wraps.
+uint32_t Oscillator::toFixed(double cycles)
 {
-    if (dt <= 0.0)
-        return 0.0;
-    if (t < dt)
+    double scaled = cycles * fixedOne;
+    return static_cast<uint32_t>(static_cast<int64_t>(scaled + (scaled < 0.0 ? -0.5 : 0.5)));
+}
+
+double Oscillator::wrapPhase(double p)
+{
+    if (p >= 1.0)
+        p -= 1.0;
+
+    // Only increments of a cycle or more per sample (or negative ones) need the slow path.
+    if (p >= 1.0 || p < 0.0)
     {
-        t /= dt;
-        return t + t - t * t - 1.0;
+        p -= std::floor(p);
+        if (p >= 1.0)
+            p = 0.0;
     }
-    if (t > 1.0 - dt)
+    return p;
+}
+
+template <Oscillator::Waveform shape>
+const float* Oscillator::getTable()
+{
+    if constexpr (shape == Waveform::Sine)
+        return getSineTable();
+    else
+        return getWavetables().data.data() + Wavetables::start(shape);
+}
+
+// Octave from the exponent bits, position within it from the mantissa: a
+// piecewise-linear log2, exact at each octave boundary, so the crossfade is
+// continuous as the pitch glides.
+static inline void mipPosition(double dt, int& offset, float& blend)
+{
+    float octaves = std::max(static_cast<float>(std::abs(dt)) * tableSize, 1.0f);
+    auto bits = std::bit_cast<uint32_t>(octaves);
+    offset = std::min(static_cast<int>(bits >> 23) - 127, Wavetables::numLevels - 1) * Wavetables::stride;
+    blend = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u) - 1.0f;
+}
+
+template <Oscillator::Waveform shape>
+float Oscillator::lookup(const float* table, int i0, float frac, int offset, float blend)
+{
+    if constexpr (shape == Waveform::Sine)
+    {
+        return table[i0] + frac * (table[i0 + 1] - table[i0]);
+    }
+    else
     {
-        t = (t - 1.0) / dt;
-        return t * t + t + t + 1.0;
+        const float* entry = table + offset + 2 * i0;
+        float s0 = entry[0] + blend * entry[1];
+        float s1 = entry[2] + blend * entry[3];
+        return s0 + frac * (s1 - s0);
     }
-    return 0.0;
+}
+
+template <Oscillator::Waveform shape>
+float Oscillator::shapeSample(const float* table, double p, int offset, float blend)
+{
+    double idx = p * tableSize;
+    auto i0 = static_cast<int>(idx);
+    return lookup<shape>(table, i0, static_cast<float>(idx - i0), offset, blend);
+}
+
+// The top 11 bits index the table and the rest are the interpolation fraction.
+template <Oscillator::Waveform shape>
+float Oscillator::shapeSample(const float* table, uint32_t p, int offset, float blend)
+{
+    constexpr int fractionBits = 32 - std::countr_zero(static_cast<unsigned>(tableSize));
+    constexpr uint32_t fractionMask = (1u << fractionBits) - 1u;
+    constexpr float fractionScale = 1.0f / static_cast<float>(1u << fractionBits);
+
+    auto i0 = static_cast<int>(p >> fractionBits);
+    return lookup<shape>(table, i0, static_cast<float>(p & fractionMask) * fractionScale, offset, blend);
 }
 
 float Oscillator::nextSample()
 {
     float out = 0.0f;
+    renderBlock(&out, 1);
+    return out;
+}
 
-    switch (waveform)
+// The phase recurrence runs first over a short chunk so the shape loop that
+// follows has no loop-carried state. The mip position is worked out alongside it,
+// where it overlaps the latency of the phase updates.
+template <Oscillator::Waveform shape, bool fixedPoint, typename IncrementFn>
+void Oscillator::renderShape(float* out, int numSamples, IncrementFn incrementAt)
+{
+    using Phase = std::conditional_t<fixedPoint, uint32_t, double>;
+    std::array<Phase, renderChunk> phases;
+    std::array<int, renderChunk> offsets;
+    std::array<float, renderChunk> blends;
+    const float* table = getTable<shape>();
+
+    for (int offset = 0; offset < numSamples; offset += renderChunk)
     {
-        case Waveform::Sine:
+        int count = std::min(renderChunk, numSamples - offset);
+
+        for (int i = 0; i < count; ++i)
         {
-            const float* table = getSineTable();
-            double idx = phase * 2048.0;
-            auto i0 = static_cast<int>(idx);
-            float frac = static_cast<float>(idx - i0);
-            out = table[i0] + frac * (table[i0 + 1] - table[i0]);
-            break;
+            double dt = incrementAt(offset + i);
+            if constexpr (fixedPoint)
+            {
+                phases[static_cast<size_t>(i)] = fixedPhase;
+                fixedPhase += toFixed(dt);
+            }
+            else
+            {
+                phases[static_cast<size_t>(i)] = phase;
+                phase = wrapPhase(phase + dt);
+            }
+
+            if constexpr (shape != Waveform::Sine)
+                mipPosition(dt, offsets[static_cast<size_t>(i)], blends[static_cast<size_t>(i)]);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto n = static_cast<size_t>(i);
+            if constexpr (shape == Waveform::Sine)
+                out[offset + i] = shapeSample<shape>(table, phases[n], 0, 0.0f);
+            else
+                out[offset + i] = shapeSample<shape>(table, phases[n], offsets[n], blends[n]);
         }
-        case Waveform::Triangle:
-            out = static_cast<float>(2.0 * std::abs(2.0 * phase - 1.0) - 1.0);
-            break;
-        case Waveform::Square:
-            out = (phase < 0.5) ? 1.0f : -1.0f;
-            out += static_cast<float>(polyBLEP(phase, phaseIncrement));
-            out -= static_cast<float>(polyBLEP(std::fmod(phase + 0.5, 1.0), phaseIncrement));
-            break;
-        case Waveform::Saw:
-            out = static_cast<float>(2.0 * phase - 1.0);
-            out -= static_cast<float>(polyBLEP(phase, phaseIncrement));
-            break;
     }
+}
 
-    phase += phaseIncrement;
-    while (phase >= 1.0)
-        phase -= 1.0;
-    while (phase < 0.0)
-        phase += 1.0;
+template <bool fixedPoint, typename IncrementFn>
+void Oscillator::renderWaveform(float* out, int numSamples, IncrementFn incrementAt)
+{
+    switch (waveform)
+    {
+        case Waveform::Sine:     renderShape<Waveform::Sine, fixedPoint>(out, numSamples, incrementAt); break;
+        case Waveform::Triangle: renderShape<Waveform::Triangle, fixedPoint>(out, numSamples, incrementAt); break;
+        case Waveform::Square:   renderShape<Waveform::Square, fixedPoint>(out, numSamples, incrementAt); break;
+        case Waveform::Saw:      renderShape<Waveform::Saw, fixedPoint>(out, numSamples, incrementAt); break;
+    }
+}
 
-    return out;
+template <typename IncrementFn>
+void Oscillator::render(float* out, int numSamples, IncrementFn incrementAt)
+{
+    if (fixedPointPhase)
+        renderWaveform<true>(out, numSamples, incrementAt);
+    else
+        renderWaveform<false>(out, numSamples, incrementAt);
+}
+
+void Oscillator::renderBlock(float* out, int numSamples, const float* frequencies)
+{
+    if (numSamples <= 0)
+        return;
+
+    if (frequencies == nullptr)
+    {
+        double dt = phaseIncrement;
+        render(out, numSamples, [dt](int) { return dt; });
+        return;
+    }
+
+    double inverseSR = 1.0 / sr;
+    render(out, numSamples, [frequencies, inverseSR](int i) { return static_cast<double>(frequencies[i]) * inverseSR; });
+    setFrequency(frequencies[numSamples - 1]);
+}
+
+void Oscillator::renderRamp(float* out, int numSamples, float targetHz)
+{
+    if (numSamples <= 0)
+        return;
+
+    double start = phaseIncrement;
+    double step = (static_cast<double>(targetHz) / sr - start) / numSamples;
+    render(out, numSamples, [start, step](int i) { return start + step * (i + 1); });
+    setFrequency(targetHz);
+}
+
+void Oscillator::renderLogRamp(float* out, int numSamples, float targetHz)
+{
+    if (numSamples <= 0)
+        return;
+
+    if (freq <= 0.0f || targetHz <= 0.0f)
+    {
+        renderRamp(out, numSamples, targetHz);
+        return;
+    }
+
+    // renderShape asks for the increments in order, so a running product stands in
+    // for a pow() per sample.
+    double ratio = std::pow(static_cast<double>(targetHz) / static_cast<double>(freq), 1.0 / numSamples);
+    render(out, numSamples, [increment = phaseIncrement, ratio](int) mutable {
+        increment *= ratio;
+        return increment;
+    });
+    setFrequency(targetHz);
 }
 
 void Oscillator::updateIncrement()
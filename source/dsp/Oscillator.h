@@ -1,24 +1,74 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 class Oscillator
 {
 public:
+    // Triangle, square and saw read band-limited wavetables, one per octave, built by
+    // the first prepare() and shared by every instance.
     enum class Waveform { Sine, Triangle, Square, Saw };
 
+    // Call from prepareToPlay: the first call builds the tables.
     void prepare(double sampleRate);
     void setFrequency(float hz);
     void setWaveform(Waveform w);
+    float getFrequency() const { return freq; }
+
+    // Keeps the phase as a 32-bit fraction of a cycle instead of a double. Wraparound
+    // is free, the table position comes from shifts and masks, and the phase of a
+    // held pitch is a plain integer induction the compiler can vectorise. Frequency
+    // resolution is sampleRate / 2^32, under a millicent from 20 Hz up at 48 kHz.
+    void setFixedPointPhase(bool shouldUseFixedPoint);
+    bool usesFixedPointPhase() const { return fixedPointPhase; }
     float nextSample();
 
+    // Renders numSamples into out. With a frequencies buffer the carrier follows it
+    // sample by sample (in Hz) and keeps the last value; with nullptr it holds the
+    // current frequency.
+    void renderBlock(float* out, int numSamples, const float* frequencies = nullptr);
+
+    // Renders numSamples while gliding linearly from the current frequency to targetHz.
+    void renderRamp(float* out, int numSamples, float targetHz);
+
+    // Same, but the glide is linear in log-frequency (a constant ratio per sample).
+    void renderLogRamp(float* out, int numSamples, float targetHz);
+
 private:
+    static constexpr int renderChunk = 64;
+    static constexpr double fixedOne = 4294967296.0; // one cycle in fixed-point phase
+
     double sr = 44100.0;
     float freq = 440.0f;
     double phase = 0.0;
     double phaseIncrement = 0.0;
+    uint32_t fixedPhase = 0;
+    bool fixedPointPhase = false;
     Waveform waveform = Waveform::Sine;
 
     void updateIncrement();
-    static double polyBLEP(double t, double dt);
+    static double wrapPhase(double p);
+    static uint32_t toFixed(double cycles);
+
+    template <Waveform shape>
+    static const float* getTable();
+
+    template <Waveform shape>
+    static float lookup(const float* table, int i0, float frac, int offset, float blend);
+
+    template <Waveform shape>
+    static float shapeSample(const float* table, double p, int offset, float blend);
+
+    template <Waveform shape>
+    static float shapeSample(const float* table, uint32_t p, int offset, float blend);
+
+    template <typename IncrementFn>
+    void render(float* out, int numSamples, IncrementFn incrementAt);
+
+    template <bool fixedPoint, typename IncrementFn>
+    void renderWaveform(float* out, int numSamples, IncrementFn incrementAt);
+
+    template <Waveform shape, bool fixedPoint, typename IncrementFn>
+    void renderShape(float* out, int numSamples, IncrementFn incrementAt);
 };
@@ -0,0 +1,165 @@
+#include "PitchDetectorGroup.h"
+#include <limits>
+
+class PitchDetectorGroup::GroupJob : public AnalysisThreadPool::Job
+{
+public:
+    explicit GroupJob(PitchDetectorGroup& owner)
+        : o(owner) {}
+
+    void run() override
+    {
+        o.numWakeups.fetch_add(1, std::memory_order_relaxed);
+
+        // The input is read in rounds of less than a minimum hop, aligned across the
+        // channels, so each channel reaches at most one hop per round and channels fed
+        // in step reach theirs in the same round. The hops that need a full FFT are
+        // then transformed two at a time.
+        for (;;)
+        {
+            auto target = std::numeric_limits<uint64_t>::max();
+            for (auto& detector : o.detectors)
+                if (detector->hasQueuedInput())
+                    target = std::min(target, detector->analysedPosition);
+
+            if (target == std::numeric_limits<uint64_t>::max())
+                break;
+
+            target = (target / roundSize + 1) * roundSize;
+
+            bool progressed = false;
+            for (auto& detector : o.detectors)
+                if (detector->analysedPosition < target)
+                    progressed |= detector->runQueuedAnalysis(static_cast<int>(target - detector->analysedPosition));
+
+            completeHeldAnalyses();
+
+            if (!progressed)
+                break;
+        }
+    }
+
+    bool hasPendingWork() const override
+    {
+        for (auto& detector : o.detectors)
+            if (detector->hasPendingAnalysis())
+                return true;
+        return false;
+    }
+
+    uint64_t roundSize = 1;
+
+private:
+    void completeHeldAnalyses()
+    {
+        YinPitchDetector* held = nullptr;
+
+        for (auto& detector : o.detectors)
+        {
+            if (!detector->awaitingDifference)
+                continue;
+
+            if (held == nullptr)
+            {
+                held = detector.get();
+                continue;
+            }
+
+            YinPitchDetector::completeAnalysisPair(*held, *detector);
+            o.numBatchedPairs.fetch_add(1, std::memory_order_relaxed);
+            held = nullptr;
+        }
+
+        if (held != nullptr)
+            held->completeAnalysis();
+    }
+
+    PitchDetectorGroup& o;
+};
+
+PitchDetectorGroup::PitchDetectorGroup()
+    : workspace(std::make_shared<YinPitchDetector::Workspace>()),
+      job(std::make_unique<GroupJob>(*this)) {}
+
+PitchDetectorGroup::~PitchDetectorGroup()
+{
+    analysisPool->suspend(*job);
+}
+
+void PitchDetectorGroup::prepare(double sampleRate, int numChannels)
+{
+    analysisPool->suspend(*job);
+
+    detectors.resize(static_cast<size_t>(std::max(1, numChannels)));
+    for (auto& detector : detectors)
+    {
+        if (detector == nullptr)
+        {
+            detector = std::make_unique<YinPitchDetector>();
+            detector->workspace = workspace;
+            detector->groupJob = job.get();
+            detector->batchDifferences = true;
+        }
+
+        detector->setDifferenceMode(differenceMode);
+        detector->setSynchronous(synchronous);
+        detector->prepare(sampleRate);
+    }
+
+    job->roundSize = static_cast<uint64_t>(std::max(1, 2 * (detectors[0]->hopSize - 1)));
+    numWakeups.store(0, std::memory_order_relaxed);
+    numBatchedPairs.store(0, std::memory_order_relaxed);
+
+    if (!synchronous)
+        analysisPool->resume(*job);
+}
+
+void PitchDetectorGroup::setSynchronous(bool shouldBeSynchronous)
+{
+    if (synchronous == shouldBeSynchronous)
+        return;
+
+    synchronous = shouldBeSynchronous;
+
+    if (synchronous)
+        analysisPool->suspend(*job);
+
+    for (auto& detector : detectors)
+        detector->setSynchronous(synchronous);
+
+    if (!synchronous && !detectors.empty())
+        analysisPool->resume(*job);
+}
+
+PitchDetectorTelemetry PitchDetectorGroup::getTelemetry() const
+{
+    PitchDetectorTelemetry total;
+    double totalAnalyseMs = 0.0;
+
+    for (auto& detector : detectors)
+    {
+        auto t = detector->getTelemetry();
+        total.fifoFill = std::max(total.fifoFill, t.fifoFill);
+        total.maxFifoFill = std::max(total.maxFifoFill, t.maxFifoFill);
+        total.fifoCapacity = t.fifoCapacity;
+        total.droppedSamples += t.droppedSamples;
+        total.numAnalyses += t.numAnalyses;
+        total.lastAnalyseMs = std::max(total.lastAnalyseMs, t.lastAnalyseMs);
+        total.maxAnalyseMs = std::max(total.maxAnalyseMs, t.maxAnalyseMs);
+        totalAnalyseMs += t.meanAnalyseMs * t.numAnalyses;
+        total.lastHopLatencyMs = std::max(total.lastHopLatencyMs, t.lastHopLatencyMs);
+        total.maxHopLatencyMs = std::max(total.maxHopLatencyMs, t.maxHopLatencyMs);
+        if (t.resultAgeMs >= 0.0 && (total.resultAgeMs < 0.0 || t.resultAgeMs < total.resultAgeMs))
+            total.resultAgeMs = t.resultAgeMs;
+    }
+
+    if (total.numAnalyses > 0)
+        total.meanAnalyseMs = totalAnalyseMs / total.numAnalyses;
+    return total;
+}
+
+void PitchDetectorGroup::flushForTest()
+{
+    for (auto& detector : detectors)
+        detector->flushForTest();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "YinPitchDetector.h"
+
+// One YinPitchDetector per channel for unlinked tracking. The detectors share one FFT
+// plan and scratch workspace, and a single pool job analyses every channel back to
+// back, so a hop that completes on several channels at once costs one wakeup. Hops
+// that need a full FFT on two channels at once share the inverse transform.
+class PitchDetectorGroup
+{
+public:
+    PitchDetectorGroup();
+    ~PitchDetectorGroup();
+
+    // Allocates; call from prepareToPlay. Channels keep their detectors across calls
+    // with the same count.
+    void prepare(double sampleRate, int numChannels);
+
+    // Takes effect on the next prepare().
+    void setDifferenceMode(YinPitchDetector::DifferenceMode mode) { differenceMode = mode; }
+
+    // As YinPitchDetector::setSynchronous, for every channel.
+    void setSynchronous(bool shouldBeSynchronous);
+    bool isSynchronous() const { return synchronous; }
+
+    int getNumChannels() const { return static_cast<int>(detectors.size()); }
+    YinPitchDetector& getDetector(int channel) { return *detectors[static_cast<size_t>(channel)]; }
+    const YinPitchDetector& getDetector(int channel) const { return *detectors[static_cast<size_t>(channel)]; }
+
+    template <typename Sample>
+    inline int feedBlock(int channel, const Sample* samples, int numSamples)
+    {
+        return detectors[static_cast<size_t>(channel)]->feedBlock(samples, numSamples);
+    }
+
+    void feedSilence(int channel, int numSamples)
+    {
+        detectors[static_cast<size_t>(channel)]->feedSilence(numSamples);
+    }
+
+    // Parks every channel from firstChannel on. The wakeups coalesce on the shared
+    // job, as for feedBlock.
+    void park(int firstChannel = 0)
+    {
+        for (size_t ch = static_cast<size_t>(std::max(0, firstChannel)); ch < detectors.size(); ++ch)
+            detectors[ch]->park();
+    }
+
+    inline PitchResult getResult(int channel) const
+    {
+        return detectors[static_cast<size_t>(channel)]->getResult();
+    }
+
+    // Every channel's telemetry in one: counts add up, fills, times and latencies are
+    // the worst channel's, and the result age is the freshest channel's.
+    PitchDetectorTelemetry getTelemetry() const;
+
+    uint32_t getNumWakeups() const { return numWakeups.load(std::memory_order_relaxed); }
+
+    // Pooled mode only: analyses that were transformed together with another channel's.
+    // Counts pairs, and restarts at prepare().
+    uint32_t getNumBatchedPairs() const { return numBatchedPairs.load(std::memory_order_relaxed); }
+
+    void flushForTest();
+
+private:
+    class GroupJob;
+
+    std::vector<std::unique_ptr<YinPitchDetector>> detectors;
+    std::shared_ptr<YinPitchDetector::Workspace> workspace;
+    YinPitchDetector::DifferenceMode differenceMode = YinPitchDetector::DifferenceMode::Batch;
+    bool synchronous = false;
+    std::atomic<uint32_t> numWakeups { 0 };
+    std::atomic<uint32_t> numBatchedPairs { 0 };
+
+    juce::SharedResourcePointer<AnalysisThreadPool> analysisPool;
+    std::unique_ptr<GroupJob> job;
+};
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include "FastMath.h"
 
 class PitchSmoother
 {
@@ -23,23 +24,37 @@ public:
         recomputeAlpha();
     }
 
+    // The block length processBlock() is usually called with, so its coefficient is
+    // computed here rather than per call. Other lengths still work.
+    inline void setBlockSize(int numSamples)
+    {
+        blockSize = std::max(1, numSamples);
+        recomputeAlpha();
+    }
+
     inline void setSensitivity(float sensitivity01)
     {
         sensitivityThreshold = std::clamp(sensitivity01, 0.0f, 1.0f);
     }
 
+    // Whether a reading would move the smoother; anything else holds the last pitch.
+    inline bool accepts(float detectedFreq, float confidence) const
+    {
+        return detectedFreq > 0.0f && confidence >= sensitivityThreshold;
+    }
+
     inline float process(float detectedFreq, float confidence)
     {
-        if (detectedFreq <= 0.0f || confidence < sensitivityThreshold)
+        if (!accepts(detectedFreq, confidence))
             return cachedFreq;
 
-        float logFreq = std::log2(detectedFreq);
+        float logFreq = FastMath::log2(detectedFreq);
 
         if (!hasValue)
         {
             smoothed = logFreq;
             hasValue = true;
-            cachedFreq = std::exp2(smoothed);
+            cachedFreq = FastMath::exp2(smoothed);
             return cachedFreq;
         }
 
@@ -50,7 +65,40 @@ public:
         smoothed += effectiveAlpha * (logFreq - smoothed);
 
         if (smoothed != prev)
-            cachedFreq = std::exp2(smoothed);
+            cachedFreq = FastMath::exp2(smoothed);
+
+        return cachedFreq;
+    }
+
+    // Advances the smoother by numSamples with one detector reading, as if process()
+    // had been called that many times with it. The log-domain one-pole is applied
+    // in closed form, so the cost does not depend on numSamples.
+    inline float processBlock(float detectedFreq, float confidence, int numSamples)
+    {
+        if (numSamples <= 1)
+            return process(detectedFreq, confidence);
+
+        if (!accepts(detectedFreq, confidence))
+            return cachedFreq;
+
+        float logFreq = FastMath::log2(detectedFreq);
+
+        if (!hasValue || std::abs(logFreq - smoothed) > 0.08f)
+        {
+            smoothed = logFreq;
+            hasValue = true;
+            cachedFreq = FastMath::exp2(smoothed);
+            return cachedFreq;
+        }
+
+        float prev = smoothed;
+        float blockAlpha = numSamples == blockSize
+                             ? cachedBlockAlpha
+                             : 1.0f - std::pow(1.0f - alpha, static_cast<float>(numSamples));
+        smoothed += blockAlpha * (logFreq - smoothed);
+
+        if (smoothed != prev)
+            cachedFreq = FastMath::exp2(smoothed);
 
         return cachedFreq;
     }
@@ -63,12 +111,16 @@ private:
             alpha = 1.0f;
         else
             alpha = 1.0f - std::exp(-1.0f / (sr * tau));
+
+        cachedBlockAlpha = 1.0f - std::pow(1.0f - alpha, static_cast<float>(blockSize));
     }
 
     float sr = 44100.0f;
     float smoothingAmount = 0.5f;
     float smoothed = 0.0f;
     float alpha = 0.5f;
+    int blockSize = 1;
+    float cachedBlockAlpha = 0.5f;
     float sensitivityThreshold = 0.5f;
     float cachedFreq = 0.0f;
     bool hasValue = false;
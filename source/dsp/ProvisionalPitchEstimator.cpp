@@ -0,0 +1,130 @@
+#include "ProvisionalPitchEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+void ProvisionalPitchEstimator::prepare(double sampleRate)
+{
+    factor = std::max(1, static_cast<int>(std::lround(sampleRate / targetRate)));
+    decimatedSR = static_cast<float>(sampleRate / factor);
+
+    window = static_cast<int>(std::ceil(decimatedSR * windowSeconds));
+    minLag = std::max(2, static_cast<int>(decimatedSR / maxFrequency));
+    maxLag = static_cast<int>(std::ceil(decimatedSR / minFrequency));
+    searchInterval = std::max(1, static_cast<int>(decimatedSR * searchSeconds));
+
+    size = maxLag + window + 1;
+    history.assign(static_cast<size_t>(2 * size), 0.0f);
+    difference.assign(static_cast<size_t>(maxLag + 2), 0.0f);
+    reset();
+}
+
+void ProvisionalPitchEstimator::reset()
+{
+    writePos = 0;
+    filled = 0;
+    accumulator = 0.0f;
+    accumulated = 0;
+    sinceSearch = searchInterval;
+    result = {};
+}
+
+template <typename Sample>
+void ProvisionalPitchEstimator::process(const Sample* samples, int numSamples, bool estimate)
+{
+    if (size == 0)
+        return;
+
+    // A box filter is enough ahead of the decimation: aliased harmonics keep the
+    // period, and only the fundamental region has to survive.
+    float scale = 1.0f / static_cast<float>(factor);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        accumulator += static_cast<float>(samples[i]);
+        if (++accumulated == factor)
+        {
+            push(accumulator * scale);
+            accumulator = 0.0f;
+            accumulated = 0;
+        }
+    }
+
+    if (!estimate)
+    {
+        result = {};
+        return;
+    }
+
+    if (sinceSearch < searchInterval)
+        return;
+
+    sinceSearch = 0;
+    result = {};
+    search();
+}
+
+template void ProvisionalPitchEstimator::process(const float*, int, bool);
+template void ProvisionalPitchEstimator::process(const double*, int, bool);
+
+void ProvisionalPitchEstimator::push(float decimated)
+{
+    history[static_cast<size_t>(writePos)] = decimated;
+    history[static_cast<size_t>(writePos + size)] = decimated;
+    if (++writePos == size)
+        writePos = 0;
+    filled = std::min(filled + 1, size);
+    ++sinceSearch;
+}
+
+// The YIN steps on the magnitude difference: cumulative-mean normalisation, the
+// first dip under the threshold, then parabolic interpolation. Only lags whose
+// whole comparison window has been heard are searched.
+void ProvisionalPitchEstimator::search()
+{
+    int lastLag = std::min(maxLag, filled - window);
+    if (lastLag < 2 * minLag)
+        return;
+
+    // Newest sample last; latest[-lag] is the same point a lag earlier.
+    const float* latest = history.data() + writePos + size - window;
+
+    float level = 0.0f;
+    for (int i = 0; i < window; ++i)
+        level += std::abs(latest[i]);
+    if (level < silenceLevel * static_cast<float>(window))
+        return;
+
+    float runningSum = 0.0f;
+    int found = 0;
+
+    for (int lag = 1; lag <= lastLag; ++lag)
+    {
+        const float* earlier = latest - lag;
+        float d = 0.0f;
+        for (int i = 0; i < window; ++i)
+            d += std::abs(latest[i] - earlier[i]);
+
+        runningSum += d;
+        float normalised = runningSum > 0.0f ? d * static_cast<float>(lag) / runningSum : 1.0f;
+        difference[static_cast<size_t>(lag)] = normalised;
+
+        // The dip has to bottom out inside the searched range.
+        if (found == 0 && lag > minLag && difference[static_cast<size_t>(lag - 1)] < threshold
+            && normalised >= difference[static_cast<size_t>(lag - 1)])
+        {
+            found = lag - 1;
+            break;
+        }
+    }
+
+    if (found == 0)
+        return;
+
+    auto tau = static_cast<size_t>(found);
+    float s0 = difference[tau - 1], s1 = difference[tau], s2 = difference[tau + 1];
+    float betterTau = static_cast<float>(found);
+    float denom = 2.0f * (2.0f * s1 - s2 - s0);
+    if (std::abs(denom) > 1e-12f)
+        betterTau += std::clamp((s2 - s0) / denom, -0.5f, 0.5f);
+
+    result = { decimatedSR / betterTau, std::clamp(1.0f - s1, 0.0f, 1.0f) };
+}
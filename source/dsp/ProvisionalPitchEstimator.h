@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include "YinPitchDetector.h"
+
+// A quick pitch guess for the audio thread, to drive the carrier in the first few
+// milliseconds after an onset while YIN is still filling its window. It runs a
+// small AMDF over a decimated copy of the input, comparing the latest 3 ms against
+// earlier ones, so a pitch shows up about one period plus 3 ms after the onset.
+// The cost is a few operations per sample to keep the history, plus one search per
+// block while an estimate is wanted.
+class ProvisionalPitchEstimator
+{
+public:
+    // Allocates; call from prepareToPlay.
+    void prepare(double sampleRate);
+
+    // Forgets the history, e.g. after silence, so the next note is not compared
+    // against the last one.
+    void reset();
+
+    // Stores the block. With estimate set, searches the latest input afterwards, at
+    // most once per millisecond of input however small the blocks; otherwise the
+    // result is cleared, so it is never left over from before YIN took over. Takes
+    // float or double input.
+    template <typename Sample>
+    void process(const Sample* samples, int numSamples, bool estimate);
+
+    PitchResult getResult() const { return result; }
+
+private:
+    void push(float decimated);
+    void search();
+
+    static constexpr double targetRate = 12000.0;
+    static constexpr double minFrequency = 80.0;  // YIN's lower limit
+    static constexpr double maxFrequency = 1200.0;
+    static constexpr double windowSeconds = 0.003;
+    static constexpr double searchSeconds = 0.001;
+    static constexpr float threshold = 0.3f;
+    static constexpr float silenceLevel = 1e-4f;  // mean magnitude over the window
+
+    int factor = 1;
+    float decimatedSR = 0.0f;
+    int window = 0;
+    int minLag = 0;
+    int maxLag = 0;
+    int searchInterval = 1;
+    int sinceSearch = 0;
+
+    // The history is written twice, size apart, so any window is contiguous.
+    std::vector<float> history;
+    int size = 0;
+    int writePos = 0;
+    int filled = 0;
+
+    float accumulator = 0.0f;
+    int accumulated = 0;
+
+    std::vector<float> difference;
+    PitchResult result;
+};
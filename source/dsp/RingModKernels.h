@@ -0,0 +1,137 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+// Block kernels for the audio path. The loops are branch-free over plain arrays so
+// the compiler can vectorise them.
+namespace RingModKernels
+{
+    // NaN and Inf are the only floats with an all-ones exponent.
+    inline uint32_t nonFiniteFlag(float x)
+    {
+        constexpr uint32_t exponentMask = 0x7f800000u;
+        return (std::bit_cast<uint32_t>(x) & exponentMask) == exponentMask ? 1u : 0u;
+    }
+
+    inline uint32_t nonFiniteFlag(double x)
+    {
+        constexpr uint64_t exponentMask = 0x7ff0000000000000ull;
+        return (std::bit_cast<uint64_t>(x) & exponentMask) == exponentMask ? 1u : 0u;
+    }
+
+    // data = dry * (1 - mix) + dry * carrier * mix, folded into one gain per sample.
+    // The non-finite check rides along in the same pass; returns true if any output
+    // sample is NaN or Inf.
+    inline bool applyRingMod(float* data, const float* carrier, const float* mix, int numSamples)
+    {
+        uint32_t found = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float out = data[i] * (1.0f + mix[i] * (carrier[i] - 1.0f));
+            data[i] = out;
+            found |= nonFiniteFlag(out);
+        }
+
+        return found != 0;
+    }
+
+    // The per-sample gain applyRingMod folds in, computed once so every channel can
+    // share it. gain may alias carrier or mix.
+    inline void ringModGain(const float* carrier, const float* mix, float* gain, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            gain[i] = 1.0f + mix[i] * (carrier[i] - 1.0f);
+    }
+
+    // The gain stays float for double buffers; only the audio itself is widened.
+    template <typename Sample>
+    uint32_t applyGain(Sample* data, const float* gain, int numSamples)
+    {
+        uint32_t found = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Sample out = data[i] * static_cast<Sample>(gain[i]);
+            data[i] = out;
+            found |= nonFiniteFlag(out);
+        }
+
+        return found;
+    }
+
+    template <typename Sample>
+    uint32_t applyGain(Sample* a, Sample* b, Sample* c, Sample* d, const float* gain, int numSamples)
+    {
+        uint32_t found = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto g = static_cast<Sample>(gain[i]);
+            Sample outA = a[i] * g, outB = b[i] * g, outC = c[i] * g, outD = d[i] * g;
+            a[i] = outA;
+            b[i] = outB;
+            c[i] = outC;
+            d[i] = outD;
+            found |= nonFiniteFlag(outA) | nonFiniteFlag(outB) | nonFiniteFlag(outC) | nonFiniteFlag(outD);
+        }
+
+        return found;
+    }
+
+    // Same result as applyRingMod on each channel in turn, but the gain is computed
+    // once and channels go four at a time, so every gain load serves four channels.
+    // Returns true if any output sample is NaN or Inf.
+    template <typename Sample>
+    bool applyGain(Sample* const* channels, int numChannels, const float* gain, int numSamples)
+    {
+        uint32_t found = 0;
+        int ch = 0;
+
+        for (; ch + 4 <= numChannels; ch += 4)
+            found |= applyGain(channels[ch], channels[ch + 1], channels[ch + 2], channels[ch + 3], gain, numSamples);
+
+        for (; ch < numChannels; ++ch)
+            found |= applyGain(channels[ch], gain, numSamples);
+
+        return found != 0;
+    }
+
+    inline uint32_t magnitudeBits(float x) { return std::bit_cast<uint32_t>(x) & 0x7fffffffu; }
+    inline uint64_t magnitudeBits(double x) { return std::bit_cast<uint64_t>(x) & 0x7fffffffffffffffull; }
+
+    // True if no sample is louder than threshold. The comparison is on the magnitude
+    // bits, where NaN and Inf sort above every finite value, so they never pass as
+    // silence.
+    template <typename Sample>
+    bool isSilent(const Sample* data, int numSamples, Sample threshold)
+    {
+        auto limit = magnitudeBits(threshold);
+        uint32_t loud = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+            loud |= magnitudeBits(data[i]) > limit ? 1u : 0u;
+
+        return loud == 0;
+    }
+
+    template <typename Sample>
+    bool containsNonFinite(const Sample* data, int numSamples)
+    {
+        uint32_t found = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+            found |= nonFiniteFlag(data[i]);
+
+        return found != 0;
+    }
+
+    template <typename Sample>
+    void zeroNonFinite(Sample* data, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            if (nonFiniteFlag(data[i]) != 0)
+                data[i] = Sample(0);
+    }
+}
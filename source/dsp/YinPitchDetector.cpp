@@ -1,181 +1,503 @@
 #include "YinPitchDetector.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
 #include <thread>
 #include <chrono>
 
-class YinPitchDetector::AnalysisThread : public juce::Thread
+class YinPitchDetector::AnalysisJob : public AnalysisThreadPool::Job
 {
 public:
-    AnalysisThread(YinPitchDetector& owner)
-        : Thread("PitchAnalysis"), o(owner) {}
+    AnalysisJob(YinPitchDetector& owner)
+        : o(owner) {}
 
     void run() override
     {
-        while (!threadShouldExit())
+        o.numWakeups.fetch_add(1, std::memory_order_relaxed);
+        consume(std::numeric_limits<int>::max());
+    }
+
+    // Reads up to maxSamples of the queued input, applying a park that falls inside
+    // it. Returns false if there was nothing to do.
+    bool consume(int maxSamples)
+    {
+        int ready = std::min(maxSamples, o.fifo.getNumReady());
+        auto park = o.parkPosition.load(std::memory_order_acquire);
+
+        // A park stored after ready was read lies past it and waits for the next run.
+        if (park != noPark && park - o.analysedPosition <= static_cast<uint64_t>(ready))
         {
-            int ready = o.fifo.getNumReady();
+            int before = static_cast<int>(park - o.analysedPosition);
+            readFifo(before);
+            o.resetAnalysis();
+            o.parkPosition.compare_exchange_strong(park, noPark, std::memory_order_relaxed);
+            ready -= before;
+
             if (ready == 0)
-            {
-                wait(1);
-                continue;
-            }
+                return true;
+        }
 
-            int start1, size1, start2, size2;
-            o.fifo.prepareToRead(ready, start1, size1, start2, size2);
+        if (ready == 0)
+            return false;
 
-            for (int i = 0; i < size1; ++i)
-                processSample(o.fifoBuffer[static_cast<size_t>(start1 + i)]);
-            for (int i = 0; i < size2; ++i)
-                processSample(o.fifoBuffer[static_cast<size_t>(start2 + i)]);
+        readFifo(ready);
+        o.updateWakeupThreshold();
+        return true;
+    }
+
+    bool hasPendingWork() const override
+    {
+        return o.fifo.getNumReady() >= o.wakeupThreshold.load(std::memory_order_relaxed)
+            || o.parkPosition.load(std::memory_order_relaxed) != noPark;
+    }
+
+    void processBlock(const float* samples, int numSamples)
+    {
+        std::array<float, decimatedChunk> decimated;
+
+        for (int offset = 0; offset < numSamples; offset += 2 * decimatedChunk)
+        {
+            int count = std::min(2 * decimatedChunk, numSamples - offset);
+            int produced = o.decimator.process(samples + offset, count, decimated.data());
+            auto chunkStart = o.analysedPosition + static_cast<uint64_t>(offset);
 
-            o.fifo.finishedRead(size1 + size2);
+            for (int i = 0; i < produced; ++i)
+                processDecimated(decimated[static_cast<size_t>(i)],
+                                 chunkStart + static_cast<uint64_t>(std::min(count, 2 * (i + 1))));
         }
+        o.analysedPosition += static_cast<uint64_t>(numSamples);
+        o.findArrival(o.analysedPosition + 1);
     }
 
 private:
-    void processSample(float sample)
+    void readFifo(int numSamples)
     {
-        if (!o.decimator.processSample(sample))
+        if (numSamples == 0)
             return;
-        float decimated = o.decimator.getOutput();
 
+        int start1, size1, start2, size2;
+        o.fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+        processBlock(o.fifoBuffer.data() + start1, size1);
+        processBlock(o.fifoBuffer.data() + start2, size2);
+
+        o.fifo.finishedRead(size1 + size2);
+    }
+
+    // inputPosition counts input samples up to and including this one.
+    void processDecimated(float decimated, uint64_t inputPosition)
+    {
         o.buffer[static_cast<size_t>(o.writePos)] = decimated;
-        if (++o.writePos >= o.windowSize) o.writePos = 0;
+        if (++o.writePos >= o.historySize) o.writePos = 0;
+        ++o.samplesWritten;
 
         o.activityEnvelope = std::max(std::abs(decimated), o.activityEnvelope * o.activityRelease);
+        o.energy += o.energyCoeff * (decimated * decimated - o.energy);
         if (o.activityEnvelope < o.silenceThreshold)
         {
-            o.activeWindowSize = 0;
-            o.hopCounter = 0;
-            o.lastResult = {};
-            o.atomicFreq.store(0.0f, std::memory_order_relaxed);
-            o.atomicConf.store(0.0f, std::memory_order_relaxed);
+            o.clearTracking();
             return;
         }
 
         o.activeWindowSize = std::min(o.activeWindowSize + 1, o.windowSize);
         ++o.hopCounter;
 
+        // A held-back analysis has to land before its result can steer the next hop.
+        if (o.awaitingDifference && o.hopCounter >= o.hopSize)
+            o.completeAnalysis();
+
         if (o.activeWindowSize < o.minAnalysisWindow)
             return;
 
-        if (o.hopCounter >= o.hopSize)
+        bool levelMoved = o.hopCounter >= o.hopSize
+                       && (o.energy > o.analysisEnergy * o.energyJump
+                           || o.energy * o.energyJump < o.analysisEnergy);
+
+        if (o.hopCounter >= o.currentHop || levelMoved)
         {
             o.hopCounter = 0;
-            o.analyse(o.activeWindowSize);
-            o.atomicFreq.store(o.lastResult.frequency, std::memory_order_relaxed);
-            o.atomicConf.store(o.lastResult.confidence, std::memory_order_relaxed);
+            o.startAnalysis(inputPosition, levelMoved);
         }
     }
 
+    static constexpr int decimatedChunk = 256;
+
     YinPitchDetector& o;
 };
 
-YinPitchDetector::YinPitchDetector() = default;
+YinPitchDetector::YinPitchDetector()
+    : workspace(std::make_shared<Workspace>()) {}
 
-YinPitchDetector::~YinPitchDetector()
+void YinPitchDetector::Workspace::prepare(int order, int windowSize)
 {
-    if (analysisThread)
+    if (fft == nullptr || fftOrder != order)
     {
-        analysisThread->signalThreadShouldExit();
-        analysisThread->notify();
-        analysisThread->waitForThreadToExit(1000);
+        fftOrder = order;
+        fft = std::make_unique<juce::dsp::FFT>(order);
     }
+
+    auto fftSize = static_cast<size_t>(1 << order);
+    auto halfWindow = static_cast<size_t>(windowSize / 2);
+
+    fftPacked.assign(fftSize, {});
+    fftSpectrum.assign(fftSize, {});
+    fftCorrelation.assign(fftSize, {});
+    fftPairCorrelation.assign(fftSize, {});
+    cmndf.resize(halfWindow);
+    coarseSignal.resize(static_cast<size_t>(windowSize / coarseFactor));
+    coarseCmndf.resize(halfWindow / coarseFactor);
+    prefixSum.resize(static_cast<size_t>(windowSize + 1));
+    prefixSquares.resize(static_cast<size_t>(windowSize + 1));
 }
 
-void YinPitchDetector::prepare(double sampleRate)
+YinPitchDetector::~YinPitchDetector()
 {
-    if (analysisThread)
-    {
-        analysisThread->signalThreadShouldExit();
-        analysisThread->notify();
-        analysisThread->waitForThreadToExit(1000);
-        analysisThread.reset();
-    }
+    if (analysisJob && groupJob == nullptr)
+        analysisPool->suspend(*analysisJob);
+}
 
+// A grouped detector is driven by its group's job, which the group suspends and
+// resumes around prepare() and mode switches.
+AnalysisThreadPool::Job* YinPitchDetector::getPoolJob() const
+{
+    if (groupJob != nullptr)
+        return groupJob;
+    return analysisJob.get();
+}
+
+void YinPitchDetector::prepare(double sampleRate)
+{
+    if (analysisJob && groupJob == nullptr)
+        analysisPool->suspend(*analysisJob);
     double decimatedSR = sampleRate / 2.0;
-    decimator.reset();
+    decimator.setDesign(decimatorDesign);
 
     analysisSR = decimatedSR;
 
     halfWindow = static_cast<int>(std::ceil(decimatedSR / 80.0));
     windowSize = 2 * halfWindow;
     hopSize = static_cast<int>(std::ceil(decimatedSR * 0.003));
+    maxHop = hopSize * std::max(1, static_cast<int>(std::round(maxHopSeconds * decimatedSR / hopSize)));
+    energyCoeff = static_cast<float>(1.0 - std::exp(-1.0 / (decimatedSR * 0.01)));
     minAnalysisWindow = 2 * static_cast<int>(std::ceil(decimatedSR / 200.0));
     minAnalysisWindow = std::min(minAnalysisWindow, windowSize);
 
-    fftOrder = static_cast<int>(std::ceil(std::log2(2.0 * windowSize)));
+    // Lags below halfWindow of a windowSize-long signal never wrap once the
+    // transform holds the whole window, so no extra zero padding is needed.
+    fftOrder = static_cast<int>(std::ceil(std::log2(static_cast<double>(windowSize))));
     fftSize = 1 << fftOrder;
-    fft = std::make_unique<juce::dsp::FFT>(fftOrder);
-    fftInput.resize(static_cast<size_t>(fftSize * 2), 0.0f);
-    fftOutput.resize(static_cast<size_t>(fftSize * 2), 0.0f);
 
-    buffer.assign(static_cast<size_t>(windowSize), 0.0f);
-    linearBuffer.resize(static_cast<size_t>(windowSize));
+    // A sliding update costs about halfWindow * slide, the batch path about
+    // fftSize * fftOrder; at high sample rates the hop grows faster than log2 of
+    // the window, so longer slides are left to the FFT. The same goes for hops the
+    // adaptive schedule has stretched: they are recomputed, and the next 3 ms hop
+    // slides again. The ring keeps maxSlide extra samples so a sliding update can
+    // see the ones leaving the window.
+    maxSlide = std::min(maxHop, slidingCostRatio * fftSize * fftOrder / halfWindow);
+    historySize = windowSize + maxSlide;
+    buffer.assign(static_cast<size_t>(historySize), 0.0f);
     diff.resize(static_cast<size_t>(halfWindow));
-    cmndf.resize(static_cast<size_t>(halfWindow));
+    linearBuffer.resize(static_cast<size_t>(historySize));
+    workspace->prepare(fftOrder, windowSize);
 
     int fifoSize = std::max(8192, static_cast<int>(sampleRate * 2.5));
     fifo.setTotalSize(fifoSize);
     fifoBuffer.resize(static_cast<size_t>(fifoSize));
 
     writePos = 0;
+    samplesWritten = 0;
     hopCounter = 0;
+    currentHop = hopSize;
+    numAnalyses.store(0, std::memory_order_relaxed);
+    numSlides.store(0, std::memory_order_relaxed);
+    numResyncs.store(0, std::memory_order_relaxed);
+    energy = 0.0f;
+    analysisEnergy = 0.0f;
+    slidingValid = false;
+    awaitingDifference = false;
+    lastAnalysisPosition = 0;
+    hopsSinceResync = 0;
+    numWakeups.store(0, std::memory_order_relaxed);
+    fedPosition = 0;
+    analysedPosition = 0;
+    arrivalFifo.reset();
+    silenceHold = static_cast<int>(sampleRate * silenceHoldSeconds);
+    silentRun = 0;
+    parked = false;
+    parkPosition.store(noPark, std::memory_order_relaxed);
+    maxFifoFill.store(0, std::memory_order_relaxed);
+    droppedSamples.store(0, std::memory_order_relaxed);
+    lastAnalyseTicks.store(0, std::memory_order_relaxed);
+    maxAnalyseTicks.store(0, std::memory_order_relaxed);
+    totalAnalyseTicks.store(0, std::memory_order_relaxed);
+    lastHopLatencyTicks.store(0, std::memory_order_relaxed);
+    maxHopLatencyTicks.store(0, std::memory_order_relaxed);
+    lastPublishTicks.store(0, std::memory_order_relaxed);
     activeWindowSize = 0;
     activityEnvelope = 0.0f;
     lastResult = {};
     atomicFreq.store(0.0f, std::memory_order_relaxed);
     atomicConf.store(0.0f, std::memory_order_relaxed);
+    updateWakeupThreshold();
 
-    analysisThread = std::make_unique<AnalysisThread>(*this);
-    analysisThread->startThread(juce::Thread::Priority::normal);
+    if (!analysisJob)
+        analysisJob = std::make_unique<AnalysisJob>(*this);
+    if (!synchronous && groupJob == nullptr)
+        analysisPool->resume(*analysisJob);
 }
 
-void YinPitchDetector::flushForTest()
+void YinPitchDetector::setSynchronous(bool shouldBeSynchronous)
 {
-    if (analysisThread)
-        analysisThread->notify();
-    while (fifo.getNumReady() > 0)
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (synchronous == shouldBeSynchronous)
+        return;
+
+    synchronous = shouldBeSynchronous;
+
+    if (!analysisJob)
+        return;
+
+    if (synchronous)
+    {
+        // Take the job off the pool, then finish whatever was still queued so no
+        // input is skipped across the switch.
+        if (groupJob == nullptr)
+            analysisPool->suspend(*analysisJob);
+        analysisJob->run();
+    }
+    else
+    {
+        updateWakeupThreshold();
+        if (groupJob == nullptr)
+            analysisPool->resume(*analysisJob);
+    }
 }
 
-void YinPitchDetector::analyse(int samplesToAnalyse)
+void YinPitchDetector::requestAnalysis()
 {
-    int activeHalfWindow = std::clamp(samplesToAnalyse / 2, 2, halfWindow);
-    int activeWindow = 2 * activeHalfWindow;
-    auto n = static_cast<size_t>(activeHalfWindow);
+    if (auto* job = getPoolJob())
+        analysisPool->submit(*job);
+}
 
-    int start = writePos - activeWindow;
-    if (start < 0)
-        start += windowSize;
+bool YinPitchDetector::runQueuedAnalysis(int maxSamples)
+{
+    return analysisJob && analysisJob->consume(maxSamples);
+}
 
-    int tail = std::min(activeWindow, windowSize - start);
-    std::copy_n(buffer.data() + start, tail, linearBuffer.data());
-    std::copy_n(buffer.data(), activeWindow - tail, linearBuffer.data() + tail);
+bool YinPitchDetector::hasQueuedInput() const
+{
+    return fifo.getNumReady() > 0 || parkPosition.load(std::memory_order_relaxed) != noPark;
+}
+
+bool YinPitchDetector::hasPendingAnalysis() const
+{
+    return analysisJob && analysisJob->hasPendingWork();
+}
+
+void YinPitchDetector::analyseInline(const float* samples, int numSamples)
+{
+    if (analysisJob)
+        analysisJob->processBlock(samples, numSamples);
+}
 
-    juce::FloatVectorOperations::clear(fftInput.data(), fftSize * 2);
-    for (size_t i = 0; i < n; ++i)
-        fftInput[i] = linearBuffer[i];
-    fft->performRealOnlyForwardTransform(fftInput.data());
+void YinPitchDetector::feedSilence(int numSamples)
+{
+    static constexpr std::array<float, 256> zeros {};
+
+    if (parked)
+        return;
+
+    int run = silentRun;
+    int toFeed = std::min(numSamples, silenceHold - run);
+    for (int offset = 0; offset < toFeed; offset += static_cast<int>(zeros.size()))
+        feedBlock(zeros.data(), std::min(static_cast<int>(zeros.size()), toFeed - offset));
+    silentRun = run + std::max(0, toFeed);
+
+    if (silentRun >= silenceHold)
+        park();
+}
+
+void YinPitchDetector::park()
+{
+    if (parked)
+        return;
+
+    parked = true;
+
+    if (synchronous)
+    {
+        resetAnalysis();
+        return;
+    }
+
+    parkPosition.store(fedPosition, std::memory_order_release);
+    requestAnalysis();
+}
+
+// The cold state the silence gate drops to, published as no pitch.
+void YinPitchDetector::clearTracking()
+{
+    if (awaitingDifference)
+        completeAnalysis();
+
+    activeWindowSize = 0;
+    hopCounter = 0;
+    currentHop = hopSize;
+    analysisEnergy = 0.0f;
+    slidingValid = false;
+    lastResult = {};
+    atomicFreq.store(0.0f, std::memory_order_relaxed);
+    atomicConf.store(0.0f, std::memory_order_relaxed);
+}
+
+// As clearTracking, but also forgets the level and the decimator history, so the
+// next input is analysed as if it followed a long silence.
+void YinPitchDetector::resetAnalysis()
+{
+    decimator.reset();
+    activityEnvelope = 0.0f;
+    energy = 0.0f;
+    clearTracking();
+    updateWakeupThreshold();
+}
+
+void YinPitchDetector::recordPublish(juce::int64 analyseTicks)
+{
+    auto now = juce::Time::getHighResolutionTicks();
+    auto took = analyseTicks;
+    lastAnalyseTicks.store(took, std::memory_order_relaxed);
+    totalAnalyseTicks.store(totalAnalyseTicks.load(std::memory_order_relaxed) + took, std::memory_order_relaxed);
+    if (took > maxAnalyseTicks.load(std::memory_order_relaxed))
+        maxAnalyseTicks.store(took, std::memory_order_relaxed);
+
+    if (analysis.arrivalTicks != 0)
+    {
+        auto latency = now - analysis.arrivalTicks;
+        lastHopLatencyTicks.store(latency, std::memory_order_relaxed);
+        if (latency > maxHopLatencyTicks.load(std::memory_order_relaxed))
+            maxHopLatencyTicks.store(latency, std::memory_order_relaxed);
+    }
+
+    lastPublishTicks.store(now, std::memory_order_relaxed);
+}
+
+// Drops the stamps of writes that ended before inputPosition; the first one left
+// is the write that brought that sample in.
+const YinPitchDetector::Arrival* YinPitchDetector::findArrival(uint64_t inputPosition)
+{
+    for (;;)
+    {
+        int start1, size1, start2, size2;
+        arrivalFifo.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 == 0)
+            return nullptr;
+
+        const auto& arrival = arrivals[static_cast<size_t>(start1)];
+        if (arrival.endPosition >= inputPosition)
+            return &arrival;
+        arrivalFifo.finishedRead(1);
+    }
+}
+
+PitchDetectorTelemetry YinPitchDetector::getTelemetry() const
+{
+    auto toMs = [](juce::int64 ticks) { return 1000.0 * juce::Time::highResolutionTicksToSeconds(ticks); };
+
+    PitchDetectorTelemetry t;
+    t.fifoFill = fifo.getNumReady();
+    t.maxFifoFill = maxFifoFill.load(std::memory_order_relaxed);
+    t.fifoCapacity = std::max(0, fifo.getTotalSize() - 1);
+    t.droppedSamples = droppedSamples.load(std::memory_order_relaxed);
+    t.numAnalyses = numAnalyses.load(std::memory_order_relaxed);
+    t.lastAnalyseMs = toMs(lastAnalyseTicks.load(std::memory_order_relaxed));
+    t.maxAnalyseMs = toMs(maxAnalyseTicks.load(std::memory_order_relaxed));
+    if (t.numAnalyses > 0)
+        t.meanAnalyseMs = toMs(totalAnalyseTicks.load(std::memory_order_relaxed)) / t.numAnalyses;
+    t.lastHopLatencyMs = toMs(lastHopLatencyTicks.load(std::memory_order_relaxed));
+    t.maxHopLatencyMs = toMs(maxHopLatencyTicks.load(std::memory_order_relaxed));
+
+    auto published = lastPublishTicks.load(std::memory_order_relaxed);
+    if (published != 0)
+        t.resultAgeMs = toMs(juce::Time::getHighResolutionTicks() - published);
+    return t;
+}
+
+void YinPitchDetector::scheduleNextHop()
+{
+    const auto& previous = analysis.previous;
+    numAnalyses.fetch_add(1, std::memory_order_relaxed);
+    analysisEnergy = analysis.energy;
+
+    bool stable = !analysis.levelMoved
+               && previous.frequency > 0.0f
+               && previous.confidence >= stableConfidence
+               && lastResult.confidence >= stableConfidence
+               && std::abs(lastResult.frequency - previous.frequency) <= previous.frequency * stableTolerance;
+
+    currentHop = stable ? std::min(currentHop * 2, maxHop) : hopSize;
+}
+
+void YinPitchDetector::updateWakeupThreshold()
+{
+    // Wake on every minimum hop even while the hop is stretched, so a level change
+    // can still cut a long hop short.
+    int decimatedNeeded = std::max(hopSize - hopCounter % hopSize, minAnalysisWindow - activeWindowSize);
+    int inputNeeded = 2 * decimatedNeeded - decimator.getPhase();
+    wakeupThreshold.store(std::max(1, inputNeeded), std::memory_order_relaxed);
+}
+
+void YinPitchDetector::flushForTest()
+{
+    auto* job = getPoolJob();
+    while (fifo.getNumReady() > 0 || (job != nullptr && !job->isIdle()))
+    {
+        requestAnalysis();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Both correlation operands go through one complex FFT: the zero-padded first
+// half-window in the real part and the full window in the imaginary part. Writes
+// the spectrum of their correlation, bins 0 to fftSize / 2.
+void YinPitchDetector::transformWindow(juce::dsp::Complex<float>* correlationSpectrum)
+{
+    auto& ws = *workspace;
+    int activeHalfWindow = analysis.halfWindow;
+    int activeWindow = 2 * activeHalfWindow;
 
-    juce::FloatVectorOperations::clear(fftOutput.data(), fftSize * 2);
     for (int i = 0; i < activeWindow; ++i)
-        fftOutput[static_cast<size_t>(i)] = linearBuffer[static_cast<size_t>(i)];
-    fft->performRealOnlyForwardTransform(fftOutput.data());
+    {
+        float sample = linearBuffer[static_cast<size_t>(i)];
+        ws.fftPacked[static_cast<size_t>(i)] = { i < activeHalfWindow ? sample : 0.0f, sample };
+    }
+    std::fill(ws.fftPacked.begin() + activeWindow, ws.fftPacked.end(), juce::dsp::Complex<float> {});
 
-    for (int k = 0; k < fftSize; ++k)
+    ws.fft->perform(ws.fftPacked.data(), ws.fftSpectrum.data(), false);
+
+    int mask = fftSize - 1;
+    for (int k = 0; k <= fftSize / 2; ++k)
     {
-        float aRe = fftInput[static_cast<size_t>(2 * k)];
-        float aIm = fftInput[static_cast<size_t>(2 * k + 1)];
-        float bRe = fftOutput[static_cast<size_t>(2 * k)];
-        float bIm = fftOutput[static_cast<size_t>(2 * k + 1)];
-        fftInput[static_cast<size_t>(2 * k)]     = aRe * bRe + aIm * bIm;
-        fftInput[static_cast<size_t>(2 * k + 1)] = aRe * bIm - aIm * bRe;
+        auto z = ws.fftSpectrum[static_cast<size_t>(k)];
+        auto zMirror = std::conj(ws.fftSpectrum[static_cast<size_t>((fftSize - k) & mask)]);
+        auto head = (z + zMirror) * 0.5f;
+        auto window = (z - zMirror) * juce::dsp::Complex<float> { 0.0f, -0.5f };
+        correlationSpectrum[k] = std::conj(head) * window;
     }
+}
+
+void YinPitchDetector::computeDifference()
+{
+    auto& ws = *workspace;
+    auto* correlation = reinterpret_cast<float*>(ws.fftCorrelation.data());
+
+    transformWindow(ws.fftCorrelation.data());
+    ws.fft->performRealOnlyInverseTransform(correlation);
+    differenceFromCorrelation(correlation, 1);
+}
 
-    fft->performRealOnlyInverseTransform(fftInput.data());
+void YinPitchDetector::differenceFromCorrelation(const float* correlation, size_t stride)
+{
+    auto n = static_cast<size_t>(analysis.halfWindow);
 
     float powerTerm0 = 0.0f;
     for (size_t j = 0; j < n; ++j)
@@ -188,78 +510,366 @@ void YinPitchDetector::analyse(int samplesToAnalyse)
     {
         powerTermTau += linearBuffer[n + tau - 1] * linearBuffer[n + tau - 1]
                       - linearBuffer[tau - 1] * linearBuffer[tau - 1];
-        diff[tau] = powerTerm0 + powerTermTau - 2.0f * fftInput[tau];
+        diff[tau] = powerTerm0 + powerTermTau - 2.0f * correlation[tau * stride];
+    }
+
+    slidingValid = analysis.halfWindow == halfWindow;
+    hopsSinceResync = 0;
+}
+
+// linearBuffer holds the previous window followed by the slide new samples. Each
+// lag drops the squared differences of the samples that left the half-window and
+// adds those of the samples that entered it, so the cost is O(halfWindow * slide).
+void YinPitchDetector::slideDifference(int slide)
+{
+    auto n = static_cast<size_t>(halfWindow);
+    const float* x = linearBuffer.data();
+    float* d = diff.data();
+
+    for (size_t j = 0; j < static_cast<size_t>(slide); ++j)
+    {
+        const float leaving = x[j];
+        const float entering = x[n + j];
+        const float* leavingLag = x + j;
+        const float* enteringLag = x + n + j;
+
+        for (size_t tau = 1; tau < n; ++tau)
+        {
+            float a = leaving - leavingLag[tau];
+            float b = entering - enteringLag[tau];
+            d[tau] += b * b - a * a;
+        }
+    }
+}
+
+// Runs YIN on a box-filtered, 4x decimated copy of the window to locate the dip, then
+// evaluates the exact CMNDF only around it. Returns 0 to fall back to the full search,
+// which also covers pitches too high for the coarse lag resolution.
+size_t YinPitchDetector::searchCoarseToFine()
+{
+    auto& ws = *workspace;
+    auto n = static_cast<size_t>(halfWindow);
+    auto nc = ws.coarseCmndf.size();
+    const float* x = linearBuffer.data();
+
+    for (size_t i = 0; i < ws.coarseSignal.size(); ++i)
+    {
+        float sum = 0.0f;
+        for (size_t k = 0; k < static_cast<size_t>(coarseFactor); ++k)
+            sum += x[i * coarseFactor + k];
+        ws.coarseSignal[i] = sum / static_cast<float>(coarseFactor);
     }
 
-    cmndf[0] = 1.0f;
+    ws.coarseCmndf[0] = 1.0f;
     float runningSum = 0.0f;
 
-    for (size_t tau = 1; tau < n; ++tau)
+    for (size_t tau = 1; tau < nc; ++tau)
     {
-        runningSum += diff[tau];
-        if (runningSum > 0.0f)
-            cmndf[tau] = diff[tau] * static_cast<float>(tau) / runningSum;
-        else
-            cmndf[tau] = 1.0f;
+        float d = 0.0f;
+        for (size_t j = 0; j < nc; ++j)
+        {
+            float delta = ws.coarseSignal[j] - ws.coarseSignal[j + tau];
+            d += delta * delta;
+        }
+
+        runningSum += d;
+        ws.coarseCmndf[tau] = runningSum > 0.0f ? d * static_cast<float>(tau) / runningSum : 1.0f;
     }
 
-    size_t tauEstimate = 0;
-    for (size_t tau = 2; tau < n; ++tau)
+    size_t coarseTau = 0;
+    for (size_t tau = 2; tau < nc; ++tau)
     {
-        if (cmndf[tau] < threshold)
+        if (ws.coarseCmndf[tau] < threshold)
         {
-            while (tau + 1 < n && cmndf[tau + 1] < cmndf[tau])
+            while (tau + 1 < nc && ws.coarseCmndf[tau + 1] < ws.coarseCmndf[tau])
                 ++tau;
-            tauEstimate = tau;
+            coarseTau = tau;
             break;
         }
     }
 
+    if (coarseTau == 0)
+        coarseTau = static_cast<size_t>(std::min_element(ws.coarseCmndf.begin() + 2, ws.coarseCmndf.end()) - ws.coarseCmndf.begin());
+
+    // A dip at the shortest coarse lags means the period may be finer than the coarse
+    // grid can resolve, and the coarse pick could be one of its multiples.
+    auto shortLags = ws.coarseCmndf.begin() + static_cast<std::ptrdiff_t>(std::min(nc, 2 * minCoarseLag));
+    if (coarseTau < minCoarseLag || *std::min_element(ws.coarseCmndf.begin() + 2, shortLags) < coarseAmbiguity)
+        return 0;
+
+    float coarseEstimate = static_cast<float>(coarseTau);
+    if (coarseTau + 1 < nc)
+    {
+        float s0 = ws.coarseCmndf[coarseTau - 1];
+        float s1 = ws.coarseCmndf[coarseTau];
+        float s2 = ws.coarseCmndf[coarseTau + 1];
+        float denom = 2.0f * (2.0f * s1 - s2 - s0);
+        if (std::abs(denom) > 1e-12f)
+            coarseEstimate += std::clamp((s2 - s0) / denom, -0.5f, 0.5f);
+    }
+
+    ws.prefixSum[0] = 0.0;
+    ws.prefixSquares[0] = 0.0;
+    for (size_t i = 0; i < 2 * n; ++i)
+    {
+        ws.prefixSum[i + 1] = ws.prefixSum[i] + x[i];
+        ws.prefixSquares[i + 1] = ws.prefixSquares[i] + static_cast<double>(x[i]) * x[i];
+    }
+
+    auto tau = static_cast<size_t>(std::lround(coarseEstimate * static_cast<float>(coarseFactor)));
+    tau = std::clamp<size_t>(tau, 2, n - 2);
+
+    ws.cmndf[tau - 1] = refineCmndf(tau - 1);
+    ws.cmndf[tau] = refineCmndf(tau);
+    ws.cmndf[tau + 1] = refineCmndf(tau + 1);
+
+    while (tau > 2 && ws.cmndf[tau - 1] < ws.cmndf[tau])
+    {
+        --tau;
+        ws.cmndf[tau - 1] = refineCmndf(tau - 1);
+    }
+
+    while (tau + 2 < n && ws.cmndf[tau + 1] < ws.cmndf[tau])
+    {
+        ++tau;
+        ws.cmndf[tau + 1] = refineCmndf(tau + 1);
+    }
+
+    return tau;
+}
+
+// Exact CMNDF at a single lag in O(halfWindow). The cumulative sum of d(1..tau) is
+// tau * P0 + sum of the lagged powers - 2 * sum_j x[j] * (x[j+1] + ... + x[j+tau]),
+// and the inner sums come from the prefix sums built by searchCoarseToFine().
+float YinPitchDetector::refineCmndf(size_t tau)
+{
+    auto& ws = *workspace;
+    auto n = static_cast<size_t>(halfWindow);
+    const float* x = linearBuffer.data();
+
+    float d = 0.0f;
+    for (size_t j = 0; j < n; ++j)
+    {
+        float delta = x[j] - x[j + tau];
+        d += delta * delta;
+    }
+
+    double laggedPower = 0.0;
+    for (size_t t = 1; t <= tau; ++t)
+        laggedPower += ws.prefixSquares[t + n] - ws.prefixSquares[t];
+
+    double cross = 0.0;
+    for (size_t j = 0; j < n; ++j)
+        cross += x[j] * (ws.prefixSum[j + tau + 1] - ws.prefixSum[j + 1]);
+
+    double runningSum = static_cast<double>(tau) * ws.prefixSquares[n] + laggedPower - 2.0 * cross;
+    if (runningSum <= 0.0)
+        return 1.0f;
+
+    return static_cast<float>(static_cast<double>(d) * static_cast<double>(tau) / runningSum);
+}
+
+void YinPitchDetector::startAnalysis(uint64_t inputPosition, bool levelMoved)
+{
+    auto started = juce::Time::getHighResolutionTicks();
+    auto* arrival = findArrival(inputPosition);
+
+    analysis.previous = lastResult;
+    analysis.levelMoved = levelMoved;
+    analysis.energy = energy;
+    analysis.arrivalTicks = arrival != nullptr ? arrival->ticks : 0;
+    analysis.elapsedTicks = 0;
+
+    if (beginAnalysis())
+    {
+        finishAnalysis(started);
+    }
+    else if (batchDifferences && !synchronous)
+    {
+        analysis.elapsedTicks = juce::Time::getHighResolutionTicks() - started;
+        awaitingDifference = true;
+    }
+    else
+    {
+        computeDifference();
+        finishAnalysis(started);
+    }
+}
+
+// Copies the window out of the history and does the work that needs no FFT: the
+// coarse search, or sliding the previous difference function. Returns false if the
+// full difference function is still to be computed.
+bool YinPitchDetector::beginAnalysis()
+{
+    analysis.halfWindow = std::clamp(activeWindowSize / 2, 2, halfWindow);
+    analysis.coarseTau = 0;
+    int activeWindow = 2 * analysis.halfWindow;
+
+    int slide = static_cast<int>(samplesWritten - lastAnalysisPosition);
+    bool sliding = differenceMode == DifferenceMode::Sliding
+                && slidingValid
+                && analysis.halfWindow == halfWindow
+                && slide > 0 && slide <= maxSlide
+                && hopsSinceResync < resyncInterval;
+
+    // When sliding, the copy starts at the previous window so the leaving samples come first.
+    int span = activeWindow + (sliding ? slide : 0);
+    int start = writePos - span;
+    if (start < 0)
+        start += historySize;
+
+    int tail = std::min(span, historySize - start);
+    std::copy_n(buffer.data() + start, tail, linearBuffer.data());
+    std::copy_n(buffer.data(), span - tail, linearBuffer.data() + tail);
+
+    lastAnalysisPosition = samplesWritten;
+
+    if (differenceMode == DifferenceMode::CoarseToFine && analysis.halfWindow == halfWindow)
+        analysis.coarseTau = searchCoarseToFine();
+
+    if (analysis.coarseTau != 0)
+        return true;
+
+    if (sliding)
+    {
+        slideDifference(slide);
+        ++hopsSinceResync;
+        numSlides.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    if (differenceMode == DifferenceMode::Sliding && slidingValid)
+        numResyncs.fetch_add(1, std::memory_order_relaxed);
+
+    return false;
+}
+
+void YinPitchDetector::completeAnalysis()
+{
+    auto started = juce::Time::getHighResolutionTicks();
+    computeDifference();
+    finishAnalysis(started);
+}
+
+// Two channels' correlations are real, so one inverse FFT serves both: the second
+// spectrum goes in as the imaginary part and its correlation comes back out there.
+// The forward transforms stay separate, so a pair costs three FFTs instead of four.
+void YinPitchDetector::completeAnalysisPair(YinPitchDetector& a, YinPitchDetector& b)
+{
+    auto started = juce::Time::getHighResolutionTicks();
+    auto& ws = *a.workspace;
+    int size = a.fftSize;
+
+    a.transformWindow(ws.fftCorrelation.data());
+    b.transformWindow(ws.fftPairCorrelation.data());
+
+    for (int k = 0; k <= size / 2; ++k)
+    {
+        auto first = ws.fftCorrelation[static_cast<size_t>(k)];
+        auto second = ws.fftPairCorrelation[static_cast<size_t>(k)];
+        juce::dsp::Complex<float> i { 0.0f, 1.0f };
+
+        ws.fftPacked[static_cast<size_t>(k)] = first + i * second;
+        if (k > 0 && k < size / 2)
+            ws.fftPacked[static_cast<size_t>(size - k)] = std::conj(first) + i * std::conj(second);
+    }
+
+    ws.fft->perform(ws.fftPacked.data(), ws.fftSpectrum.data(), true);
+
+    const auto* correlations = reinterpret_cast<const float*>(ws.fftSpectrum.data());
+    a.differenceFromCorrelation(correlations, 2);
+    b.differenceFromCorrelation(correlations + 1, 2);
+
+    // The shared transforms are split evenly between the two in the telemetry.
+    auto now = juce::Time::getHighResolutionTicks();
+    a.analysis.elapsedTicks += (now - started) / 2;
+    b.analysis.elapsedTicks += (now - started) / 2;
+    a.finishAnalysis(now);
+    b.finishAnalysis(juce::Time::getHighResolutionTicks());
+}
+
+void YinPitchDetector::finishAnalysis(juce::int64 started)
+{
+    auto& ws = *workspace;
+    auto n = static_cast<size_t>(analysis.halfWindow);
+    size_t tauEstimate = analysis.coarseTau;
+
     if (tauEstimate == 0)
     {
-        float minVal = 1.0f;
+        ws.cmndf[0] = 1.0f;
+        float runningSum = 0.0f;
+
+        for (size_t tau = 1; tau < n; ++tau)
+        {
+            runningSum += diff[tau];
+            if (runningSum > 0.0f)
+                ws.cmndf[tau] = diff[tau] * static_cast<float>(tau) / runningSum;
+            else
+                ws.cmndf[tau] = 1.0f;
+        }
+
         for (size_t tau = 2; tau < n; ++tau)
         {
-            if (cmndf[tau] < minVal)
+            if (ws.cmndf[tau] < threshold)
             {
-                minVal = cmndf[tau];
+                while (tau + 1 < n && ws.cmndf[tau + 1] < ws.cmndf[tau])
+                    ++tau;
                 tauEstimate = tau;
+                break;
+            }
+        }
+
+        if (tauEstimate == 0)
+        {
+            float minVal = 1.0f;
+            for (size_t tau = 2; tau < n; ++tau)
+            {
+                if (ws.cmndf[tau] < minVal)
+                {
+                    minVal = ws.cmndf[tau];
+                    tauEstimate = tau;
+                }
             }
         }
     }
 
+    lastResult = estimatePitch(tauEstimate);
+    awaitingDifference = false;
+
+    scheduleNextHop();
+    atomicFreq.store(lastResult.frequency, std::memory_order_relaxed);
+    atomicConf.store(lastResult.confidence, std::memory_order_relaxed);
+    recordPublish(analysis.elapsedTicks + juce::Time::getHighResolutionTicks() - started);
+}
+
+PitchResult YinPitchDetector::estimatePitch(size_t tauEstimate) const
+{
+    const auto& ws = *workspace;
+    auto n = static_cast<size_t>(analysis.halfWindow);
+
     if (tauEstimate == 0)
-    {
-        lastResult = { 0.0f, 0.0f };
-        return;
-    }
+        return {};
 
     float betterTau = static_cast<float>(tauEstimate);
 
     if (tauEstimate > 0 && tauEstimate < n - 1)
     {
-        float s0 = cmndf[tauEstimate - 1];
-        float s1 = cmndf[tauEstimate];
-        float s2 = cmndf[tauEstimate + 1];
+        float s0 = ws.cmndf[tauEstimate - 1];
+        float s1 = ws.cmndf[tauEstimate];
+        float s2 = ws.cmndf[tauEstimate + 1];
         float denom = 2.0f * (2.0f * s1 - s2 - s0);
         if (std::abs(denom) > 1e-12f)
             betterTau += (s2 - s0) / denom;
     }
 
     if (betterTau < 1.0f)
-    {
-        lastResult = { 0.0f, 0.0f };
-        return;
-    }
+        return {};
 
     float freq = static_cast<float>(analysisSR) / betterTau;
-    float conf = 1.0f - cmndf[tauEstimate];
+    float conf = 1.0f - ws.cmndf[tauEstimate];
 
     if (freq < 20.0f || freq > 5000.0f)
-    {
-        lastResult = { 0.0f, 0.0f };
-        return;
-    }
+        return {};
 
-    lastResult = { freq, std::clamp(conf, 0.0f, 1.0f) };
+    return { freq, std::clamp(conf, 0.0f, 1.0f) };
 }
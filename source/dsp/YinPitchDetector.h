@@ -1,9 +1,14 @@
 #pragma once
 
 #include <juce_dsp/juce_dsp.h>
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 #include <vector>
+#include "AnalysisThreadPool.h"
 #include "HalfbandDecimator.h"
 
 struct PitchResult
@@ -12,72 +17,347 @@ struct PitchResult
     float confidence = 0.0f;
 };
 
+struct PitchDetectorTelemetry
+{
+    int fifoFill = 0;               // input samples waiting for the analysis thread
+    int maxFifoFill = 0;            // high-water mark since prepare()
+    int fifoCapacity = 0;
+    uint64_t droppedSamples = 0;    // input lost to a full FIFO
+    uint32_t numAnalyses = 0;
+    double lastAnalyseMs = 0.0;
+    double maxAnalyseMs = 0.0;
+    double meanAnalyseMs = 0.0;
+    double lastHopLatencyMs = 0.0;  // last sample of a hop arriving -> its result published
+    double maxHopLatencyMs = 0.0;
+    double resultAgeMs = -1.0;      // since the last analysis published; negative before the first
+};
+
 class YinPitchDetector
 {
 public:
+    enum class DifferenceMode
+    {
+        Batch,       // full difference function every hop
+        Sliding,     // update only the terms touched by the hop, resync periodically
+        CoarseToFine // search a 4x decimated copy, then refine a few lags at full rate
+    };
+
     YinPitchDetector();
     ~YinPitchDetector();
 
     void prepare(double sampleRate);
 
+    // Takes effect on the next prepare().
+    void setDecimatorDesign(HalfbandDecimator::Design design) { decimatorDesign = design; }
+    void setDifferenceMode(DifferenceMode mode) { differenceMode = mode; }
+
+    // Upper bound for the adaptive hop. The hop doubles from 3 ms while the estimate
+    // stays put and drops back as soon as the pitch or input level moves. Passing
+    // 0.003 or less gives a fixed 3 ms hop. Takes effect on the next prepare().
+    void setMaxHopSeconds(double seconds) { maxHopSeconds = seconds; }
+
+    // Runs the analysis on the feeding thread as each hop completes instead of on the
+    // shared pool, so results depend only on the input. For offline rendering and
+    // tests; call from the thread that feeds the detector.
+    void setSynchronous(bool shouldBeSynchronous);
+    bool isSynchronous() const { return synchronous; }
+
+    // A one-sample feedBlock(). Queued samples are only stamped for the telemetry
+    // once they complete the next hop, so feeding one at a time does not fill the
+    // stamp ring before the hop's last sample arrives.
     inline void feedSample(float sample)
     {
-        int start1, size1, start2, size2;
-        fifo.prepareToWrite(1, start1, size1, start2, size2);
-        if (size1 > 0)
-            fifoBuffer[static_cast<size_t>(start1)] = sample;
-        fifo.finishedWrite(size1 + size2);
+        bool completesHop = fifo.getNumReady() + 1 >= wakeupThreshold.load(std::memory_order_relaxed);
+        queue(&sample, 1, synchronous || completesHop);
     }
 
+    // Queues a whole block with a single FIFO reservation. Double input is narrowed
+    // as it is copied in. Returns the number of samples that did not fit and were
+    // dropped; never drops in synchronous mode.
+    template <typename Sample>
+    inline int feedBlock(const Sample* samples, int numSamples)
+    {
+        return queue(samples, numSamples, true);
+    }
+
+    // Stands in for numSamples of digital silence. A short gap is fed as zeros and
+    // analysed as before; once the silence lasts longer than the hold the detector
+    // parks. Feeding resumes from the same clean state as after prepare().
+    void feedSilence(int numSamples);
+
+    // Drops to the silent state after the input fed so far, without further input.
+    // The analysis thread is woken once to do it and then left alone until the next
+    // feed. Cheap to call repeatedly.
+    void park();
+    bool isParked() const { return parked; }
+
     inline PitchResult getResult() const
     {
         return { atomicFreq.load(std::memory_order_relaxed),
                  atomicConf.load(std::memory_order_relaxed) };
     }
 
+    uint32_t getNumWakeups() const { return numWakeups.load(std::memory_order_relaxed); }
+    uint32_t getNumAnalyses() const { return numAnalyses.load(std::memory_order_relaxed); }
+
+    // Sliding mode only: analyses that slid the previous difference function, and
+    // full recomputes that replaced a slidable one (the periodic resync, or a hop
+    // too long to slide cheaply).
+    uint32_t getNumSlides() const { return numSlides.load(std::memory_order_relaxed); }
+    uint32_t getNumResyncs() const { return numResyncs.load(std::memory_order_relaxed); }
+
+    // Lock-free; callable from any thread. Counters restart at prepare().
+    PitchDetectorTelemetry getTelemetry() const;
+
     void flushForTest();
+    const std::vector<float>& getDifferenceForTest() const { return diff; }
 
 private:
-    void analyse(int samplesToAnalyse);
+    // The FFT plan and the scratch every analysis rebuilds from the history. Detectors
+    // at the same sample rate that never analyse at the same time can share one.
+    struct Workspace
+    {
+        void prepare(int order, int windowSize);
+
+        std::unique_ptr<juce::dsp::FFT> fft;
+        int fftOrder = -1;
+        std::vector<juce::dsp::Complex<float>> fftPacked;
+        std::vector<juce::dsp::Complex<float>> fftSpectrum;
+        std::vector<juce::dsp::Complex<float>> fftCorrelation;
+        std::vector<juce::dsp::Complex<float>> fftPairCorrelation;
+        std::vector<float> cmndf;
+        std::vector<float> coarseSignal;
+        std::vector<float> coarseCmndf;
+        std::vector<double> prefixSum;
+        std::vector<double> prefixSquares;
+    };
+
+    // One analysis, from the hop that starts it to the published result. The window
+    // is copied out of the history first, so a grouped detector can hold the FFT back
+    // until another channel needs one and transform the two together.
+    void startAnalysis(uint64_t inputPosition, bool levelMoved);
+    bool beginAnalysis();
+    void completeAnalysis();
+    static void completeAnalysisPair(YinPitchDetector& a, YinPitchDetector& b);
+    void finishAnalysis(juce::int64 started);
+    PitchResult estimatePitch(size_t tauEstimate) const;
+
+    void transformWindow(juce::dsp::Complex<float>* correlationSpectrum);
+    void computeDifference();
+    void differenceFromCorrelation(const float* correlation, size_t stride);
+    void slideDifference(int slide);
+    size_t searchCoarseToFine();
+    float refineCmndf(size_t tau);
+    void scheduleNextHop();
+    void requestAnalysis();
+    AnalysisThreadPool::Job* getPoolJob() const;
+    bool runQueuedAnalysis(int maxSamples);
+    bool hasQueuedInput() const;
+    bool hasPendingAnalysis() const;
+    void analyseInline(const float* samples, int numSamples);
+    void clearTracking();
+    void resetAnalysis();
+    void updateWakeupThreshold();
+    void recordPublish(juce::int64 analyseTicks);
+    struct Arrival;
+    const Arrival* findArrival(uint64_t inputPosition);
 
-    class AnalysisThread;
-    friend class AnalysisThread;
+    template <typename Sample>
+    inline int queue(const Sample* samples, int numSamples, bool stamp)
+    {
+        silentRun = 0;
+        parked = false;
+
+        if (synchronous)
+        {
+            stampArrival(numSamples);
+            if constexpr (std::is_same_v<Sample, float>)
+            {
+                analyseInline(samples, numSamples);
+            }
+            else
+            {
+                std::array<float, 256> narrowed;
+                for (int offset = 0; offset < numSamples; offset += static_cast<int>(narrowed.size()))
+                {
+                    int count = std::min(static_cast<int>(narrowed.size()), numSamples - offset);
+                    copyNarrowed(samples + offset, count, narrowed.data());
+                    analyseInline(narrowed.data(), count);
+                }
+            }
+            return 0;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+        if (size1 > 0)
+            copyNarrowed(samples, size1, fifoBuffer.data() + start1);
+        if (size2 > 0)
+            copyNarrowed(samples + size1, size2, fifoBuffer.data() + start2);
+        if (stamp)
+            stampArrival(size1 + size2);
+        else
+            fedPosition += static_cast<uint64_t>(size1 + size2);
+        fifo.finishedWrite(size1 + size2);
+        recordFeed(numSamples - (size1 + size2));
+        notifyQueued();
+        return numSamples - (size1 + size2);
+    }
+
+    template <typename Sample>
+    static inline void copyNarrowed(const Sample* in, int numSamples, float* out)
+    {
+        std::transform(in, in + numSamples, out, [](Sample x) { return static_cast<float>(x); });
+    }
+
+    // Feeding-thread side of the telemetry. Each write leaves an arrival time keyed
+    // by its end position, so the analysis side can tell when a hop's last sample came in.
+    inline void stampArrival(int numSamples)
+    {
+        fedPosition += static_cast<uint64_t>(numSamples);
+
+        int start1, size1, start2, size2;
+        arrivalFifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 > 0)
+            arrivals[static_cast<size_t>(start1)] = { fedPosition, juce::Time::getHighResolutionTicks() };
+        arrivalFifo.finishedWrite(size1);
+    }
+
+    inline void recordFeed(int dropped)
+    {
+        if (dropped > 0)
+            droppedSamples.store(droppedSamples.load(std::memory_order_relaxed) + static_cast<uint64_t>(dropped),
+                                 std::memory_order_relaxed);
+
+        int fill = fifo.getNumReady();
+        if (fill > maxFifoFill.load(std::memory_order_relaxed))
+            maxFifoFill.store(fill, std::memory_order_relaxed);
+    }
+
+    // The pool is only woken once the FIFO holds enough input to complete the next hop.
+    inline void notifyQueued()
+    {
+        if (fifo.getNumReady() >= wakeupThreshold.load(std::memory_order_relaxed))
+            requestAnalysis();
+    }
+
+    class AnalysisJob;
+    friend class AnalysisJob;
+    friend class PitchDetectorGroup;
 
     double analysisSR = 44100.0;
     int windowSize = 0;
     int halfWindow = 0;
     int hopSize = 0;
+    int maxHop = 0;
+    int currentHop = 0;
+    int maxSlide = 0;
+    int historySize = 0;
+    double maxHopSeconds = 0.012;
 
     std::vector<float> buffer;
-    std::vector<float> linearBuffer;
     int writePos = 0;
+    uint32_t samplesWritten = 0;
     int hopCounter = 0;
     int activeWindowSize = 0;
     int minAnalysisWindow = 0;
     float activityEnvelope = 0.0f;
+    float energy = 0.0f;
+    float energyCoeff = 0.0f;
+    float analysisEnergy = 0.0f;
 
-    std::unique_ptr<juce::dsp::FFT> fft;
     int fftOrder = 0;
     int fftSize = 0;
-    std::vector<float> fftInput;
-    std::vector<float> fftOutput;
 
+    // Kept across hops by the sliding difference, so never shared. The window copy
+    // is per detector too, as it waits for the FFT while a group holds one back.
     std::vector<float> diff;
-    std::vector<float> cmndf;
+    std::vector<float> linearBuffer;
+
+    std::shared_ptr<Workspace> workspace;
+
+    DifferenceMode differenceMode = DifferenceMode::Batch;
+    bool synchronous = false;
+    bool slidingValid = false;
+    uint32_t lastAnalysisPosition = 0;
+    int hopsSinceResync = 0;
 
     PitchResult lastResult;
 
+    struct Analysis
+    {
+        PitchResult previous;
+        bool levelMoved = false;
+        float energy = 0.0f;           // the level at the hop, for the next level check
+        juce::int64 arrivalTicks = 0;  // when the hop's last sample came in; 0 if unknown
+        juce::int64 elapsedTicks = 0;  // spent on it before the difference was held back
+        int halfWindow = 0;
+        size_t coarseTau = 0;
+    };
+
+    Analysis analysis;
+    bool batchDifferences = false;     // set by a group
+    bool awaitingDifference = false;
+
     static constexpr float threshold = 0.15f;
     static constexpr float silenceThreshold = 1e-5f;
     static constexpr float activityRelease = 0.995f;
+    static constexpr int resyncInterval = 32;
+    static constexpr int slidingCostRatio = 3;
+    static constexpr int coarseFactor = 4;
+    static constexpr size_t minCoarseLag = 6;
+    static constexpr float coarseAmbiguity = 0.5f;
+    static constexpr float stableConfidence = 0.9f;
+    static constexpr float stableTolerance = 0.003f; // ~5 cents
+    static constexpr float energyJump = 2.0f;
 
     juce::AbstractFifo fifo { 0 };
     std::vector<float> fifoBuffer;
 
-    std::unique_ptr<AnalysisThread> analysisThread;
+    struct Arrival
+    {
+        uint64_t endPosition = 0;
+        juce::int64 ticks = 0;
+    };
+
+    // If the analysis thread falls this many writes behind, hops are matched to a
+    // later arrival and their latency reads low.
+    static constexpr int arrivalSlots = 256;
+    juce::AbstractFifo arrivalFifo { arrivalSlots };
+    std::array<Arrival, arrivalSlots> arrivals;
+    uint64_t fedPosition = 0;
+    uint64_t analysedPosition = 0;
+
+    // Feeding-thread silence state. A park is handed to the analysis thread as the
+    // input position it applies at, so input fed after it is still analysed.
+    static constexpr uint64_t noPark = ~uint64_t { 0 };
+    static constexpr double silenceHoldSeconds = 0.1;
+    int silenceHold = 0;
+    int silentRun = 0;
+    bool parked = false;
+    std::atomic<uint64_t> parkPosition { noPark };
+
+    juce::SharedResourcePointer<AnalysisThreadPool> analysisPool;
+    std::unique_ptr<AnalysisJob> analysisJob;
+    AnalysisThreadPool::Job* groupJob = nullptr;
 
     std::atomic<float> atomicFreq { 0.0f };
     std::atomic<float> atomicConf { 0.0f };
+    std::atomic<int> wakeupThreshold { 1 };
+    std::atomic<uint32_t> numWakeups { 0 };
+    std::atomic<uint32_t> numAnalyses { 0 };
+    std::atomic<uint32_t> numSlides { 0 };
+    std::atomic<uint32_t> numResyncs { 0 };
+
+    std::atomic<int> maxFifoFill { 0 };
+    std::atomic<uint64_t> droppedSamples { 0 };
+    std::atomic<juce::int64> lastAnalyseTicks { 0 };
+    std::atomic<juce::int64> maxAnalyseTicks { 0 };
+    std::atomic<juce::int64> totalAnalyseTicks { 0 };
+    std::atomic<juce::int64> lastHopLatencyTicks { 0 };
+    std::atomic<juce::int64> maxHopLatencyTicks { 0 };
+    std::atomic<juce::int64> lastPublishTicks { 0 };
 
     HalfbandDecimator decimator;
+    HalfbandDecimator::Design decimatorDesign = HalfbandDecimator::Design::Compact;
 };
@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "dsp/AnalysisThreadPool.h"
+#include "dsp/YinPitchDetector.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct CountingJob : AnalysisThreadPool::Job
+    {
+        void run() override
+        {
+            runs.fetch_add(1);
+            pending.store(0);
+        }
+
+        bool hasPendingWork() const override { return pending.load() > 0; }
+
+        std::atomic<int> runs { 0 };
+        std::atomic<int> pending { 0 };
+    };
+
+    // Consumes everything produced so far, like a detector draining its FIFO.
+    struct DrainingJob : AnalysisThreadPool::Job
+    {
+        void run() override { consumed.store(produced.load()); }
+        bool hasPendingWork() const override { return consumed.load() < produced.load(); }
+
+        std::atomic<int> produced { 0 };
+        std::atomic<int> consumed { 0 };
+    };
+
+    void waitUntilIdle(const AnalysisThreadPool::Job& job)
+    {
+        while (!job.isIdle())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST_CASE("AnalysisThreadPool: worker count is bounded by the core count")
+{
+    juce::SharedResourcePointer<AnalysisThreadPool> pool;
+    REQUIRE(pool->getNumWorkers() == juce::jmax(1, juce::SystemStats::getNumCpus()));
+}
+
+TEST_CASE("AnalysisThreadPool: instances share one pool")
+{
+    juce::SharedResourcePointer<AnalysisThreadPool> a;
+    juce::SharedResourcePointer<AnalysisThreadPool> b;
+    REQUIRE(&a.get() == &b.get());
+}
+
+TEST_CASE("AnalysisThreadPool: every submitted job runs")
+{
+    juce::SharedResourcePointer<AnalysisThreadPool> pool;
+    std::vector<std::unique_ptr<CountingJob>> jobs;
+    for (int i = 0; i < 200; ++i)
+        jobs.push_back(std::make_unique<CountingJob>());
+
+    for (auto& job : jobs)
+    {
+        job->pending.store(1);
+        REQUIRE(pool->submit(*job));
+    }
+
+    for (auto& job : jobs)
+    {
+        waitUntilIdle(*job);
+        REQUIRE(job->runs.load() == 1);
+    }
+}
+
+TEST_CASE("AnalysisThreadPool: work produced while a job finishes is not lost")
+{
+    juce::SharedResourcePointer<AnalysisThreadPool> pool;
+    DrainingJob job;
+
+    // A submit that loses the race with the worker finishing is rejected; the
+    // worker must then see the new work itself and requeue the job.
+    for (int i = 0; i < 100000; ++i)
+    {
+        job.produced.fetch_add(1);
+        pool->submit(job);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (job.consumed.load() < job.produced.load() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    waitUntilIdle(job);
+    REQUIRE(job.consumed.load() == job.produced.load());
+}
+
+TEST_CASE("AnalysisThreadPool: suspended jobs are rejected until resumed")
+{
+    juce::SharedResourcePointer<AnalysisThreadPool> pool;
+    CountingJob job;
+
+    pool->suspend(job);
+    job.pending.store(1);
+    REQUIRE_FALSE(pool->submit(job));
+    REQUIRE(job.runs.load() == 0);
+
+    pool->resume(job);
+    waitUntilIdle(job);
+    REQUIRE(job.runs.load() == 1);
+}
+
+TEST_CASE("AnalysisThreadPool: many detectors track independently on the shared pool")
+{
+    constexpr int numDetectors = 24;
+    constexpr double sampleRate = 44100.0;
+    constexpr int blockSize = 256;
+
+    std::vector<std::unique_ptr<YinPitchDetector>> detectors;
+    std::vector<double> phases(numDetectors, 0.0);
+    for (int i = 0; i < numDetectors; ++i)
+    {
+        detectors.push_back(std::make_unique<YinPitchDetector>());
+        detectors.back()->prepare(sampleRate);
+    }
+
+    std::vector<float> block(blockSize);
+    for (int fed = 0; fed < 22050; fed += blockSize)
+    {
+        for (int d = 0; d < numDetectors; ++d)
+        {
+            double inc = 6.283185307179586476925 * (110.0 + 20.0 * d) / sampleRate;
+            for (auto& s : block)
+            {
+                s = static_cast<float>(std::sin(phases[static_cast<size_t>(d)]));
+                phases[static_cast<size_t>(d)] += inc;
+            }
+            detectors[static_cast<size_t>(d)]->feedBlock(block.data(), blockSize);
+        }
+    }
+
+    for (int d = 0; d < numDetectors; ++d)
+    {
+        auto& yin = *detectors[static_cast<size_t>(d)];
+        yin.flushForTest();
+        REQUIRE_THAT(static_cast<double>(yin.getResult().frequency),
+                     Catch::Matchers::WithinRel(110.0 + 20.0 * d, 0.02));
+    }
+}
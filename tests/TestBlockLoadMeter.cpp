@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "dsp/BlockLoadMeter.h"
+#include <atomic>
+#include <thread>
+
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+TEST_CASE("BlockLoadMeter: empty meter reports nothing")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    auto s = meter.getSnapshot();
+    REQUIRE(s.numBlocks == 0);
+    REQUIRE(s.numOverruns == 0);
+    REQUIRE(s.maxLoad == 0.0f);
+    REQUIRE(s.p99Load == 0.0f);
+}
+
+TEST_CASE("BlockLoadMeter: converts ticks to a fraction of the block duration")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    // A 480-sample block lasts 10 ms; spending 2.5 ms on it is 25% load.
+    auto ticks = juce::Time::getHighResolutionTicksPerSecond() / 400;
+    meter.recordTicks(ticks, 480);
+
+    auto s = meter.getSnapshot();
+    REQUIRE(s.numBlocks == 1);
+    REQUIRE_THAT(s.lastLoad, WithinRel(0.25f, 1e-4f));
+    REQUIRE_THAT(s.maxLoad, WithinRel(0.25f, 1e-4f));
+    REQUIRE(s.numOverruns == 0);
+}
+
+TEST_CASE("BlockLoadMeter: bins are log-spaced and cover the recorded load")
+{
+    for (float load : { 0.0f, 0.0005f, 0.002f, 0.01f, 0.1f, 0.5f, 0.99f, 1.5f, 3.0f })
+    {
+        int bin = BlockLoadMeter::binFor(load);
+        INFO("load " << load << " bin " << bin);
+        REQUIRE(bin >= 0);
+        REQUIRE(bin < BlockLoadMeter::numBins);
+        REQUIRE(BlockLoadMeter::binLowerEdge(bin) <= load * 1.0001f);
+        REQUIRE(BlockLoadMeter::binUpperEdge(bin) >= load * 0.9999f);
+    }
+
+    REQUIRE_THAT(BlockLoadMeter::binUpperEdge(8) / BlockLoadMeter::binUpperEdge(0), WithinRel(2.0f, 1e-5f));
+    REQUIRE(BlockLoadMeter::binFor(100.0f) == BlockLoadMeter::numBins - 1);
+}
+
+TEST_CASE("BlockLoadMeter: p99 ignores the slowest one percent")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    for (int i = 0; i < 990; ++i)
+        meter.recordLoad(0.1f);
+    for (int i = 0; i < 10; ++i)
+        meter.recordLoad(0.9f);
+
+    auto s = meter.getSnapshot();
+    REQUIRE(s.numBlocks == 1000);
+    REQUIRE(s.maxLoad == 0.9f);
+    REQUIRE(s.p99Load >= 0.1f);
+    REQUIRE(s.p99Load <= 0.1f * 1.1f);
+    REQUIRE_THAT(s.meanLoad, WithinAbs(0.108f, 1e-4f));
+
+    meter.recordLoad(0.9f);
+    REQUIRE(meter.getSnapshot().p99Load >= 0.9f * 0.9f);
+}
+
+TEST_CASE("BlockLoadMeter: counts blocks that overran their deadline")
+{
+    BlockLoadMeter meter;
+    meter.prepare(44100.0);
+
+    meter.recordLoad(0.5f);
+    meter.recordLoad(1.0f);
+    meter.recordLoad(1.2f);
+    meter.recordLoad(4.0f);
+
+    auto s = meter.getSnapshot();
+    REQUIRE(s.numOverruns == 2);
+    REQUIRE(s.maxLoad == 4.0f);
+
+    uint64_t total = 0;
+    for (auto count : s.histogram)
+        total += count;
+    REQUIRE(total == 4);
+}
+
+TEST_CASE("BlockLoadMeter: reset takes effect on the next recorded block")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    meter.recordLoad(2.0f);
+    meter.reset();
+    meter.recordLoad(0.2f);
+
+    auto s = meter.getSnapshot();
+    REQUIRE(s.numBlocks == 1);
+    REQUIRE(s.numOverruns == 0);
+    REQUIRE(s.maxLoad == 0.2f);
+}
+
+TEST_CASE("BlockLoadMeter: snapshots taken during writes are consistent")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    std::atomic<bool> done { false };
+    std::thread writer([&]
+    {
+        for (int i = 0; i < 200000; ++i)
+            meter.recordLoad(i % 2 == 0 ? 0.25f : 1.5f);
+        done.store(true);
+    });
+
+    int checked = 0;
+    while (!done.load() || checked == 0)
+    {
+        auto s = meter.getSnapshot();
+        uint64_t total = 0;
+        for (auto count : s.histogram)
+            total += count;
+
+        REQUIRE(total == s.numBlocks);
+        REQUIRE(s.numOverruns == s.numBlocks / 2);
+        ++checked;
+    }
+
+    writer.join();
+    REQUIRE(meter.getSnapshot().numBlocks == 200000);
+}
+
+TEST_CASE("BlockLoadMeter: overhead of timing a block", "[.benchmark]")
+{
+    BlockLoadMeter meter;
+    meter.prepare(48000.0);
+
+    BENCHMARK("ScopedTimer around an empty block")
+    {
+        BlockLoadMeter::ScopedTimer timer(meter, 512);
+        return 0;
+    };
+
+    BENCHMARK("recordLoad")
+    {
+        meter.recordLoad(0.3f);
+        return 0;
+    };
+
+    BENCHMARK("getSnapshot")
+    {
+        return meter.getSnapshot().p99Load;
+    };
+}
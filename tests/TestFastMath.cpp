@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "dsp/FastMath.h"
+#include <cmath>
+#include <vector>
+
+static constexpr double minHz = 20.0;
+static constexpr double maxHz = 5000.0;
+static constexpr int numPoints = 200000;
+
+static double frequencyAt(int i)
+{
+    return minHz * std::pow(maxHz / minHz, static_cast<double>(i) / (numPoints - 1));
+}
+
+TEST_CASE("FastMath: log2Approx stays within 0.02 cents over 20 Hz to 5 kHz")
+{
+    double worstCents = 0.0;
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto hz = static_cast<float>(frequencyAt(i));
+        double error = static_cast<double>(FastMath::log2Approx(hz)) - std::log2(static_cast<double>(hz));
+        worstCents = std::max(worstCents, std::abs(error) * 1200.0);
+    }
+
+    INFO("worst error " << worstCents << " cents");
+    REQUIRE(worstCents < 0.02);
+}
+
+TEST_CASE("FastMath: exp2Approx stays within 0.01 cents over 20 Hz to 5 kHz")
+{
+    double worstCents = 0.0;
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto logHz = static_cast<float>(std::log2(frequencyAt(i)));
+        double exact = std::exp2(static_cast<double>(logHz));
+        double error = std::log2(static_cast<double>(FastMath::exp2Approx(logHz)) / exact);
+        worstCents = std::max(worstCents, std::abs(error) * 1200.0);
+    }
+
+    INFO("worst error " << worstCents << " cents");
+    REQUIRE(worstCents < 0.01);
+}
+
+TEST_CASE("FastMath: round trip through log2 and exp2 stays within 0.03 cents")
+{
+    for (int i = 0; i < numPoints; i += 7)
+    {
+        auto hz = static_cast<float>(frequencyAt(i));
+        float roundTrip = FastMath::exp2Approx(FastMath::log2Approx(hz));
+        REQUIRE(std::abs(std::log2(static_cast<double>(roundTrip) / hz)) * 1200.0 < 0.03);
+    }
+}
+
+TEST_CASE("FastMath: exp2Approx handles negative exponents and clamps out of range")
+{
+    for (float x : { -0.5f, -1.0f, -3.25f, -20.0f })
+        REQUIRE(std::abs(FastMath::exp2Approx(x) / std::exp2(x) - 1.0f) < 1e-5f);
+
+    REQUIRE(std::isfinite(FastMath::exp2Approx(1000.0f)));
+    REQUIRE(FastMath::exp2Approx(-1000.0f) > 0.0f);
+}
+
+TEST_CASE("FastMath: block forms match the scalar approximations")
+{
+    std::vector<float> hz(1001), logs(1001), back(1001);
+    for (size_t i = 0; i < hz.size(); ++i)
+        hz[i] = static_cast<float>(frequencyAt(static_cast<int>(i) * (numPoints / 1000)));
+
+    FastMath::log2Approx(hz.data(), logs.data(), static_cast<int>(hz.size()));
+    FastMath::exp2Approx(logs.data(), back.data(), static_cast<int>(logs.size()));
+
+    for (size_t i = 0; i < hz.size(); ++i)
+    {
+        REQUIRE(logs[i] == FastMath::log2Approx(hz[i]));
+        REQUIRE(back[i] == FastMath::exp2Approx(logs[i]));
+    }
+}
+
+TEST_CASE("FastMath: log2 and exp2 follow HDN_FAST_MATH")
+{
+    for (float hz : { 20.0f, 82.4f, 440.0f, 4999.0f })
+    {
+        if constexpr (HDN_FAST_MATH != 0)
+        {
+            REQUIRE(FastMath::log2(hz) == FastMath::log2Approx(hz));
+            REQUIRE(FastMath::exp2(std::log2(hz)) == FastMath::exp2Approx(std::log2(hz)));
+        }
+        else
+        {
+            REQUIRE(FastMath::log2(hz) == std::log2(hz));
+            REQUIRE(FastMath::exp2(std::log2(hz)) == std::exp2(std::log2(hz)));
+        }
+    }
+}
+
+TEST_CASE("FastMath: benchmarks against the standard library", "[.benchmark]")
+{
+    std::vector<float> hz(512), out(512);
+    for (size_t i = 0; i < hz.size(); ++i)
+        hz[i] = static_cast<float>(frequencyAt(static_cast<int>(i) * (numPoints / 512)));
+
+    BENCHMARK("std::log2, 512 values")
+    {
+        for (size_t i = 0; i < hz.size(); ++i)
+            out[i] = std::log2(hz[i]);
+        return out[0];
+    };
+
+    BENCHMARK("log2Approx, 512 values")
+    {
+        FastMath::log2Approx(hz.data(), out.data(), static_cast<int>(hz.size()));
+        return out[0];
+    };
+
+    std::vector<float> exponents(512);
+    for (size_t i = 0; i < exponents.size(); ++i)
+        exponents[i] = std::log2(hz[i]);
+
+    BENCHMARK("std::exp2, 512 values")
+    {
+        for (size_t i = 0; i < exponents.size(); ++i)
+            out[i] = std::exp2(exponents[i]);
+        return out[0];
+    };
+
+    BENCHMARK("exp2Approx, 512 values")
+    {
+        FastMath::exp2Approx(exponents.data(), out.data(), static_cast<int>(exponents.size()));
+        return out[0];
+    };
+}
@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "dsp/HalfbandDecimator.h"
+#include <array>
+#include <cmath>
+#include <vector>
+
+static constexpr double twoPi = 6.283185307179586476925;
+
+static std::vector<float> makeSine(double cyclesPerSample, int numSamples)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = static_cast<float>(std::sin(twoPi * cyclesPerSample * i));
+    return out;
+}
+
+static float decimatedPeak(HalfbandDecimator::Design design, double cyclesPerSample)
+{
+    HalfbandDecimator dec;
+    dec.setDesign(design);
+
+    auto input = makeSine(cyclesPerSample, 8192);
+    std::vector<float> output(input.size() / 2);
+    int produced = dec.process(input.data(), static_cast<int>(input.size()), output.data());
+
+    float peak = 0.0f;
+    for (int i = produced / 2; i < produced; ++i)
+        peak = std::max(peak, std::abs(output[static_cast<size_t>(i)]));
+    return peak;
+}
+
+TEST_CASE("HalfbandDecimator: compact design matches the direct 7-tap convolution")
+{
+    const std::array<float, 7> taps = { -0.03125f, 0.0f, 0.28125f, 0.5f, 0.28125f, 0.0f, -0.03125f };
+    auto input = makeSine(0.013, 1000);
+
+    HalfbandDecimator dec;
+    std::vector<float> output(input.size() / 2);
+    int produced = dec.process(input.data(), static_cast<int>(input.size()), output.data());
+    REQUIRE(produced == 500);
+
+    for (int m = 0; m < produced; ++m)
+    {
+        int n = 2 * m + 1;
+        float expected = 0.0f;
+        for (int k = 0; k < 7; ++k)
+            if (n - k >= 0)
+                expected += taps[static_cast<size_t>(k)] * input[static_cast<size_t>(n - k)];
+
+        REQUIRE_THAT(static_cast<double>(output[static_cast<size_t>(m)]),
+                     Catch::Matchers::WithinAbs(static_cast<double>(expected), 1e-6));
+    }
+}
+
+TEST_CASE("HalfbandDecimator: block output is independent of block boundaries")
+{
+    for (auto design : { HalfbandDecimator::Design::Compact, HalfbandDecimator::Design::Steep })
+    {
+        auto input = makeSine(0.021, 3001);
+
+        HalfbandDecimator whole;
+        whole.setDesign(design);
+        std::vector<float> expected(input.size());
+        int expectedCount = whole.process(input.data(), static_cast<int>(input.size()), expected.data());
+
+        HalfbandDecimator perSample;
+        perSample.setDesign(design);
+        std::vector<float> samples;
+        for (auto x : input)
+            if (perSample.processSample(x))
+                samples.push_back(perSample.getOutput());
+
+        HalfbandDecimator chunked;
+        chunked.setDesign(design);
+        std::vector<float> chunks(input.size());
+        int chunkCount = 0;
+        const int sizes[] = { 1, 7, 64, 129, 3, 200 };
+        for (size_t pos = 0, s = 0; pos < input.size(); ++s)
+        {
+            int n = std::min(sizes[s % 6], static_cast<int>(input.size() - pos));
+            chunkCount += chunked.process(input.data() + pos, n, chunks.data() + chunkCount);
+            pos += static_cast<size_t>(n);
+        }
+
+        REQUIRE(expectedCount == 1500);
+        REQUIRE(chunkCount == expectedCount);
+        REQUIRE(static_cast<int>(samples.size()) == expectedCount);
+
+        for (int i = 0; i < expectedCount; ++i)
+        {
+            REQUIRE(chunks[static_cast<size_t>(i)] == expected[static_cast<size_t>(i)]);
+            REQUIRE(samples[static_cast<size_t>(i)] == expected[static_cast<size_t>(i)]);
+        }
+    }
+}
+
+TEST_CASE("HalfbandDecimator: both designs pass low frequencies at unity gain")
+{
+    REQUIRE_THAT(static_cast<double>(decimatedPeak(HalfbandDecimator::Design::Compact, 0.01)),
+                 Catch::Matchers::WithinAbs(1.0, 0.01));
+    REQUIRE_THAT(static_cast<double>(decimatedPeak(HalfbandDecimator::Design::Steep, 0.01)),
+                 Catch::Matchers::WithinAbs(1.0, 0.01));
+}
+
+TEST_CASE("HalfbandDecimator: steep design rejects components that would alias")
+{
+    float compact = decimatedPeak(HalfbandDecimator::Design::Compact, 0.37);
+    float steep = decimatedPeak(HalfbandDecimator::Design::Steep, 0.37);
+
+    REQUIRE(steep < 1e-3f);
+    REQUIRE(steep < compact * 0.01f);
+}
+
+TEST_CASE("HalfbandDecimator: reset clears pending input and history")
+{
+    HalfbandDecimator dec;
+    float x = 1.0f;
+    dec.processSample(x);
+    REQUIRE(dec.getPhase() == 1);
+
+    dec.reset();
+    REQUIRE(dec.getPhase() == 0);
+    REQUIRE_FALSE(dec.processSample(0.0f));
+    REQUIRE(dec.processSample(0.0f));
+    REQUIRE(dec.getOutput() == 0.0f);
+}
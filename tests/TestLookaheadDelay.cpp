@@ -0,0 +1,214 @@
+#include <catch2/catch_test_macros.hpp>
+#include "dsp/LookaheadDelay.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+static std::vector<float> ramp(int numSamples, float start)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = start + static_cast<float>(i);
+    return out;
+}
+
+// Runs both channels through the delay in blocks of blockSize and returns them.
+static std::vector<std::vector<float>> runInBlocks(LookaheadDelay& delay, std::vector<std::vector<float>> channels, int blockSize)
+{
+    auto numSamples = static_cast<int>(channels[0].size());
+
+    for (int offset = 0; offset < numSamples; offset += blockSize)
+    {
+        int count = std::min(blockSize, numSamples - offset);
+        float* ptrs[2] = { channels[0].data() + offset, channels[1].data() + offset };
+        delay.process(ptrs, 2, count);
+    }
+    return channels;
+}
+
+TEST_CASE("LookaheadDelay: zero delay passes audio through")
+{
+    LookaheadDelay delay;
+    delay.prepare(2, 1000);
+
+    auto out = runInBlocks(delay, { ramp(700, 1.0f), ramp(700, -1000.0f) }, 128);
+    REQUIRE(out[0] == ramp(700, 1.0f));
+    REQUIRE(out[1] == ramp(700, -1000.0f));
+}
+
+TEST_CASE("LookaheadDelay: delays each channel by exactly the set amount")
+{
+    for (int delaySamples : { 1, 37, 511, 512, 513, 1000 })
+    {
+        for (int blockSize : { 1, 32, 100, 512, 1500 })
+        {
+            LookaheadDelay delay;
+            delay.prepare(2, 1000);
+            delay.setDelay(delaySamples);
+
+            const int numSamples = 5000;
+            auto left = ramp(numSamples, 1.0f);
+            auto right = ramp(numSamples, -10000.0f);
+            auto out = runInBlocks(delay, { left, right }, blockSize);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto n = static_cast<size_t>(i);
+                float expectedLeft = i < delaySamples ? 0.0f : left[n - static_cast<size_t>(delaySamples)];
+                float expectedRight = i < delaySamples ? 0.0f : right[n - static_cast<size_t>(delaySamples)];
+                REQUIRE(out[0][n] == expectedLeft);
+                REQUIRE(out[1][n] == expectedRight);
+            }
+        }
+    }
+}
+
+TEST_CASE("LookaheadDelay: delay is clamped to the prepared maximum")
+{
+    LookaheadDelay delay;
+    delay.prepare(1, 256);
+
+    delay.setDelay(10000);
+    REQUIRE(delay.getDelay() == 256);
+
+    delay.setDelay(-5);
+    REQUIRE(delay.getDelay() == 0);
+
+    delay.setDelay(300);
+    delay.prepare(1, 100);
+    REQUIRE(delay.getDelay() == 100);
+}
+
+TEST_CASE("LookaheadDelay: reset clears the history")
+{
+    LookaheadDelay delay;
+    delay.prepare(2, 64);
+    delay.setDelay(64);
+
+    runInBlocks(delay, { ramp(200, 1.0f), ramp(200, 1.0f) }, 200);
+    delay.reset();
+
+    auto out = runInBlocks(delay, { std::vector<float>(64, 0.5f), std::vector<float>(64, 0.5f) }, 64);
+    REQUIRE(out[0] == std::vector<float>(64, 0.0f));
+    REQUIRE(out[1] == std::vector<float>(64, 0.0f));
+}
+
+TEST_CASE("LookaheadDelay: a change while running crossfades between the delays")
+{
+    for (auto [from, to] : { std::pair { 0, 200 }, std::pair { 200, 50 }, std::pair { 50, 300 } })
+    {
+        for (int blockSize : { 32, 512 })
+        {
+            LookaheadDelay delay;
+            delay.prepare(1, 400);
+            delay.setDelay(from);
+
+            // A ramp, so both read positions and the mix between them are easy to predict.
+            const int before = 1024, numSamples = 3000;
+            auto input = ramp(numSamples, 1.0f);
+            auto out = input;
+
+            for (int offset = 0; offset < numSamples; offset += blockSize)
+            {
+                if (offset == before)
+                    delay.setDelay(to);
+
+                float* ptrs[1] = { out.data() + offset };
+                delay.process(ptrs, 1, std::min(blockSize, numSamples - offset));
+            }
+
+            auto delayed = [&input](int i, int samples)
+            {
+                return i < samples ? 0.0 : static_cast<double>(input[static_cast<size_t>(i - samples)]);
+            };
+
+            INFO(from << " to " << to << " samples in blocks of " << blockSize);
+            for (int i = 0; i < numSamples; ++i)
+            {
+                double expected = delayed(i, from);
+                if (i >= before)
+                {
+                    double gain = std::min(1.0, static_cast<double>(i - before + 1) / LookaheadDelay::fadeSamples);
+                    expected += gain * (delayed(i, to) - expected);
+                }
+                REQUIRE(out[static_cast<size_t>(i)] == static_cast<float>(expected));
+            }
+        }
+    }
+}
+
+TEST_CASE("LookaheadDelay: a change during a fade waits for it instead of jumping")
+{
+    for (int blockSize : { 16, 32, 512 })
+    {
+        LookaheadDelay delay;
+        delay.prepare(1, 400);
+
+        // Automation in short blocks: a new delay every 64 samples, each well inside
+        // the previous fade.
+        const int numSamples = 4000;
+        const int changes[] = { 200, 50, 300, 120 };
+        auto input = ramp(numSamples, 1.0f);
+        auto out = input;
+
+        for (int offset = 0; offset < numSamples; offset += blockSize)
+        {
+            for (int n = 0; n < 4; ++n)
+                if (offset <= 1024 + 64 * n && 1024 + 64 * n < offset + blockSize)
+                    delay.setDelay(changes[n]);
+
+            float* ptrs[1] = { out.data() + offset };
+            delay.process(ptrs, 1, std::min(blockSize, numSamples - offset));
+        }
+
+        // On a ramp with a step of 1, fading between two delays adds at most the
+        // difference spread over the fade.
+        double maxStep = 1.0 + 400.0 / LookaheadDelay::fadeSamples;
+        INFO("blocks of " << blockSize);
+        for (int i = 1; i < numSamples; ++i)
+            REQUIRE(std::abs(out[static_cast<size_t>(i)] - out[static_cast<size_t>(i - 1)]) <= maxStep);
+
+        // Settles on the last delay set.
+        REQUIRE(delay.getDelay() == 120);
+        for (int i = numSamples - 500; i < numSamples; ++i)
+            REQUIRE(out[static_cast<size_t>(i)] == input[static_cast<size_t>(i - 120)]);
+    }
+}
+
+TEST_CASE("LookaheadDelay: leaves channels beyond the prepared count untouched")
+{
+    LookaheadDelay delay;
+    delay.prepare(1, 16);
+    delay.setDelay(8);
+
+    auto first = ramp(32, 1.0f);
+    auto second = ramp(32, 100.0f);
+    float* ptrs[2] = { first.data(), second.data() };
+    delay.process(ptrs, 2, 32);
+
+    REQUIRE(first[0] == 0.0f);
+    REQUIRE(first[8] == 1.0f);
+    REQUIRE(second == ramp(32, 100.0f));
+}
+
+TEST_CASE("LookaheadDelay: double buffers come back at full precision")
+{
+    LookaheadDelay delay;
+    delay.prepare(1, 100);
+    delay.setDelay(25);
+
+    std::vector<double> data(300);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = 1.0 + 1.0e-12 * static_cast<double>(i);
+    auto input = data;
+
+    for (int offset = 0; offset < 300; offset += 64)
+    {
+        double* ptrs[1] = { data.data() + offset };
+        delay.process(ptrs, 1, std::min(64, 300 - offset));
+    }
+
+    for (size_t i = 0; i < data.size(); ++i)
+        REQUIRE(data[i] == (i < 25 ? 0.0 : input[i - 25]));
+}
@@ -2,6 +2,7 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include "dsp/Oscillator.h"
 #include <cmath>
+#include <complex>
 #include <vector>
 
 static constexpr double kSampleRate = 44100.0;
@@ -151,3 +152,293 @@ TEST_CASE("Oscillator: polyBLEP guard handles zero dt")
     float sample = osc.nextSample();
     REQUIRE(std::isfinite(sample));
 }
+
+static const Oscillator::Waveform allWaveforms[] = {
+    Oscillator::Waveform::Sine,
+    Oscillator::Waveform::Triangle,
+    Oscillator::Waveform::Square,
+    Oscillator::Waveform::Saw
+};
+
+TEST_CASE("Oscillator: renderBlock at a fixed frequency matches nextSample")
+{
+    for (auto wf : allWaveforms)
+    {
+        DYNAMIC_SECTION("waveform " << static_cast<int>(wf))
+        {
+            Oscillator reference, block;
+            for (auto* osc : { &reference, &block })
+            {
+                osc->prepare(kSampleRate);
+                osc->setWaveform(wf);
+                osc->setFrequency(1234.5f);
+            }
+
+            auto expected = generate(reference, 1000);
+            std::vector<float> actual(1000);
+            block.renderBlock(actual.data(), 300);
+            block.renderBlock(actual.data() + 300, 700);
+
+            for (size_t i = 0; i < expected.size(); ++i)
+                REQUIRE(actual[i] == expected[i]);
+        }
+    }
+}
+
+TEST_CASE("Oscillator: renderBlock follows a per-sample frequency buffer")
+{
+    for (auto wf : allWaveforms)
+    {
+        DYNAMIC_SECTION("waveform " << static_cast<int>(wf))
+        {
+            Oscillator reference, block;
+            for (auto* osc : { &reference, &block })
+            {
+                osc->prepare(kSampleRate);
+                osc->setWaveform(wf);
+            }
+
+            std::vector<float> frequencies(777);
+            for (size_t i = 0; i < frequencies.size(); ++i)
+                frequencies[i] = 100.0f + 3.0f * static_cast<float>(i);
+
+            std::vector<float> expected(frequencies.size());
+            for (size_t i = 0; i < frequencies.size(); ++i)
+            {
+                reference.setFrequency(frequencies[i]);
+                expected[i] = reference.nextSample();
+            }
+
+            std::vector<float> actual(frequencies.size());
+            block.renderBlock(actual.data(), static_cast<int>(actual.size()), frequencies.data());
+
+            for (size_t i = 0; i < expected.size(); ++i)
+                REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+
+            REQUIRE(block.getFrequency() == frequencies.back());
+        }
+    }
+}
+
+TEST_CASE("Oscillator: renderRamp glides linearly to the target frequency")
+{
+    Oscillator ramp, buffered;
+    for (auto* osc : { &ramp, &buffered })
+    {
+        osc->prepare(kSampleRate);
+        osc->setWaveform(Oscillator::Waveform::Saw);
+        osc->setFrequency(200.0f);
+    }
+
+    const int numSamples = 512;
+    std::vector<float> frequencies(numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        frequencies[static_cast<size_t>(i)] = 200.0f + 400.0f * static_cast<float>(i + 1) / numSamples;
+
+    std::vector<float> expected(numSamples), actual(numSamples);
+    buffered.renderBlock(expected.data(), numSamples, frequencies.data());
+    ramp.renderRamp(actual.data(), numSamples, 600.0f);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+
+    REQUIRE(ramp.getFrequency() == 600.0f);
+
+    std::vector<float> tail(64), tailExpected(64);
+    ramp.renderBlock(tail.data(), 64);
+    buffered.renderBlock(tailExpected.data(), 64);
+    for (size_t i = 0; i < tail.size(); ++i)
+        REQUIRE_THAT(tail[i], Catch::Matchers::WithinAbs(tailExpected[i], 1e-4));
+}
+
+TEST_CASE("Oscillator: renderLogRamp glides with a constant frequency ratio")
+{
+    Oscillator ramp, buffered;
+    for (auto* osc : { &ramp, &buffered })
+    {
+        osc->prepare(kSampleRate);
+        osc->setWaveform(Oscillator::Waveform::Triangle);
+        osc->setFrequency(110.0f);
+    }
+
+    const int numSamples = 32;
+    std::vector<float> frequencies(numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        frequencies[static_cast<size_t>(i)] = 110.0f * std::pow(2.0f, static_cast<float>(i + 1) / numSamples);
+
+    std::vector<float> expected(numSamples), actual(numSamples);
+    buffered.renderBlock(expected.data(), numSamples, frequencies.data());
+    ramp.renderLogRamp(actual.data(), numSamples, 220.0f);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+
+    REQUIRE(ramp.getFrequency() == 220.0f);
+}
+
+// Energy outside the harmonics of f, relative to the total. With a whole number of
+// cycles in the buffer the harmonics are orthogonal, so anything left over is aliasing.
+static double inharmonicRatio(const std::vector<float>& buf, double freq)
+{
+    const double twoPi = 6.283185307179586;
+    double total = 0.0;
+    for (auto s : buf)
+        total += static_cast<double>(s) * s;
+
+    double harmonic = 0.0;
+    for (int h = 1; h * freq < kSampleRate / 2.0; ++h)
+    {
+        std::complex<double> sum;
+        for (size_t i = 0; i < buf.size(); ++i)
+            sum += static_cast<double>(buf[i]) * std::polar(1.0, -twoPi * h * freq * static_cast<double>(i) / kSampleRate);
+        harmonic += 2.0 * std::norm(sum) / static_cast<double>(buf.size());
+    }
+
+    return (total - harmonic) / total;
+}
+
+TEST_CASE("Oscillator: triangle, square and saw are band-limited")
+{
+    // 3 kHz puts the aliases of the naive shapes between the harmonics.
+    for (auto wf : { Oscillator::Waveform::Triangle, Oscillator::Waveform::Square, Oscillator::Waveform::Saw })
+    {
+        DYNAMIC_SECTION("waveform " << static_cast<int>(wf))
+        {
+            Oscillator osc;
+            osc.prepare(kSampleRate);
+            osc.setWaveform(wf);
+            osc.setFrequency(3000.0f);
+
+            std::vector<float> buf(static_cast<size_t>(kSampleRate));
+            osc.renderBlock(buf.data(), static_cast<int>(buf.size()));
+
+            REQUIRE(inharmonicRatio(buf, 3000.0) < 1e-6);
+        }
+    }
+}
+
+TEST_CASE("Oscillator: wavetable crossfade is continuous across octave boundaries")
+{
+    for (auto wf : { Oscillator::Waveform::Triangle, Oscillator::Waveform::Square, Oscillator::Waveform::Saw })
+    {
+        DYNAMIC_SECTION("waveform " << static_cast<int>(wf))
+        {
+            // Increments of 2^j / 2048 cycles per sample are where one octave's pair
+            // of tables hands over to the next.
+            for (int octave = 0; octave < 10; ++octave)
+            {
+                auto boundary = static_cast<float>(kSampleRate * std::ldexp(1.0, octave) / 2048.0);
+
+                Oscillator below, above;
+                for (auto* osc : { &below, &above })
+                {
+                    osc->prepare(kSampleRate);
+                    osc->setWaveform(wf);
+                }
+                below.setFrequency(boundary * 0.99999f);
+                above.setFrequency(boundary * 1.00001f);
+
+                // Short, so the slightly different rates do not drift apart on the edges.
+                auto a = generate(below, 16);
+                auto b = generate(above, 16);
+                for (size_t i = 0; i < a.size(); ++i)
+                    REQUIRE_THAT(a[i], Catch::Matchers::WithinAbs(b[i], 1e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("Oscillator: fixed-point phase does not drift from the double phase")
+{
+    // A minute at 48 kHz. Each fixed-point increment is within half a step of the exact
+    // one, so the two phases can part by at most 2^-33 cycles per sample.
+    const double sampleRate = 48000.0;
+    const int numSamples = 48000 * 60;
+    const int blockSize = 512;
+    const double bound = 6.283185307179586 * numSamples / 8589934592.0 + 1e-5;
+
+    for (float freq : { 27.5f, 440.0f, 1234.567f, 4186.01f })
+    {
+        DYNAMIC_SECTION(freq << " Hz")
+        {
+            Oscillator reference, fixed;
+            for (auto* osc : { &reference, &fixed })
+            {
+                osc->prepare(sampleRate);
+                osc->setFrequency(freq);
+            }
+            fixed.setFixedPointPhase(true);
+
+            std::vector<float> expected(blockSize), actual(blockSize);
+            float maxError = 0.0f;
+            for (int offset = 0; offset < numSamples; offset += blockSize)
+            {
+                reference.renderBlock(expected.data(), blockSize);
+                fixed.renderBlock(actual.data(), blockSize);
+            }
+            for (int i = 0; i < blockSize; ++i)
+                maxError = std::max(maxError, std::abs(actual[static_cast<size_t>(i)] - expected[static_cast<size_t>(i)]));
+
+            REQUIRE(maxError <= bound);
+        }
+    }
+}
+
+TEST_CASE("Oscillator: fixed-point phase follows glides and frequency buffers")
+{
+    for (auto wf : allWaveforms)
+    {
+        DYNAMIC_SECTION("waveform " << static_cast<int>(wf))
+        {
+            Oscillator reference, fixed;
+            for (auto* osc : { &reference, &fixed })
+            {
+                osc->prepare(kSampleRate);
+                osc->setWaveform(wf);
+                osc->setFrequency(150.0f);
+            }
+            fixed.setFixedPointPhase(true);
+            REQUIRE(fixed.usesFixedPointPhase());
+
+            std::vector<float> frequencies(300);
+            for (size_t i = 0; i < frequencies.size(); ++i)
+                frequencies[i] = 150.0f + 5.0f * static_cast<float>(i);
+
+            std::vector<float> expected(1000), actual(1000);
+            for (auto* osc : { &reference, &fixed })
+            {
+                auto* out = osc == &reference ? expected.data() : actual.data();
+                osc->renderLogRamp(out, 32, 300.0f);
+                osc->renderRamp(out + 32, 200, 2500.0f);
+                osc->renderBlock(out + 232, 300, frequencies.data());
+                osc->renderBlock(out + 532, 468);
+            }
+
+            for (size_t i = 0; i < expected.size(); ++i)
+                REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+        }
+    }
+}
+
+TEST_CASE("Oscillator: switching the phase format keeps the phase")
+{
+    Oscillator reference, switched;
+    for (auto* osc : { &reference, &switched })
+    {
+        osc->prepare(kSampleRate);
+        osc->setWaveform(Oscillator::Waveform::Saw);
+        osc->setFrequency(333.0f);
+    }
+
+    std::vector<float> expected(900), actual(900);
+    reference.renderBlock(expected.data(), 900);
+
+    switched.renderBlock(actual.data(), 300);
+    switched.setFixedPointPhase(true);
+    switched.renderBlock(actual.data() + 300, 300);
+    switched.setFixedPointPhase(false);
+    switched.renderBlock(actual.data() + 600, 300);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-4));
+}
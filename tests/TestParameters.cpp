@@ -11,10 +11,14 @@ TEST_CASE("ParameterIDs: all IDs are unique")
         ParameterIDs::mode,
         ParameterIDs::smoothing,
         ParameterIDs::sensitivity,
-        ParameterIDs::waveform
+        ParameterIDs::waveform,
+        ParameterIDs::lookahead,
+        ParameterIDs::detectSource,
+        ParameterIDs::detectChannel,
+        ParameterIDs::detectCount
     };
 
-    constexpr int count = 7;
+    constexpr int count = 11;
     for (int i = 0; i < count; ++i)
         for (int j = i + 1; j < count; ++j)
             REQUIRE(std::strcmp(ids[i], ids[j]) != 0);
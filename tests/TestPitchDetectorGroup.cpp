@@ -0,0 +1,230 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include "dsp/PitchDetectorGroup.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static constexpr double twoPi = 6.283185307179586476925;
+
+static std::vector<float> makeSine(double sampleRate, double freq, int numSamples)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(twoPi * freq * i / sampleRate));
+    return out;
+}
+
+// Feeds each channel its own signal in host-sized blocks.
+static void feedChannels(PitchDetectorGroup& group, const std::vector<std::vector<float>>& signals, int blockSize)
+{
+    auto numSamples = static_cast<int>(signals[0].size());
+
+    for (int offset = 0; offset < numSamples; offset += blockSize)
+    {
+        int count = std::min(blockSize, numSamples - offset);
+        for (size_t ch = 0; ch < signals.size(); ++ch)
+            group.feedBlock(static_cast<int>(ch), signals[ch].data() + offset, count);
+    }
+}
+
+TEST_CASE("PitchDetectorGroup: each channel tracks its own pitch")
+{
+    const double sr = 48000.0;
+    std::vector<std::vector<float>> signals = { makeSine(sr, 110.0, 24000), makeSine(sr, 330.0, 24000),
+                                                std::vector<float>(24000, 0.0f), makeSine(sr, 880.0, 24000) };
+
+    for (bool synchronous : { false, true })
+    {
+        PitchDetectorGroup group;
+        group.setSynchronous(synchronous);
+        group.prepare(sr, 4);
+        REQUIRE(group.getNumChannels() == 4);
+
+        feedChannels(group, signals, 256);
+        group.flushForTest();
+
+        INFO((synchronous ? "synchronous" : "pooled"));
+        REQUIRE_THAT(static_cast<double>(group.getResult(0).frequency), Catch::Matchers::WithinRel(110.0, 0.01));
+        REQUIRE_THAT(static_cast<double>(group.getResult(1).frequency), Catch::Matchers::WithinRel(330.0, 0.01));
+        REQUIRE(group.getResult(2).frequency == 0.0f);
+        REQUIRE_THAT(static_cast<double>(group.getResult(3).frequency), Catch::Matchers::WithinRel(880.0, 0.01));
+    }
+}
+
+TEST_CASE("PitchDetectorGroup: shared workspace gives the same results as separate detectors")
+{
+    const double sr = 44100.0;
+    std::vector<std::vector<float>> signals = { makeSine(sr, 196.0, 20000), makeSine(sr, 261.6, 20000) };
+
+    for (auto mode : { YinPitchDetector::DifferenceMode::Batch, YinPitchDetector::DifferenceMode::Sliding,
+                       YinPitchDetector::DifferenceMode::CoarseToFine })
+    {
+        PitchDetectorGroup group;
+        group.setSynchronous(true);
+        group.setDifferenceMode(mode);
+        group.prepare(sr, 2);
+
+        YinPitchDetector separate[2];
+        for (auto& detector : separate)
+        {
+            detector.setSynchronous(true);
+            detector.setDifferenceMode(mode);
+            detector.prepare(sr);
+        }
+
+        for (int offset = 0; offset < 20000; offset += 500)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                group.feedBlock(ch, signals[static_cast<size_t>(ch)].data() + offset, 500);
+                separate[ch].feedBlock(signals[static_cast<size_t>(ch)].data() + offset, 500);
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                REQUIRE(group.getResult(ch).frequency == separate[ch].getResult().frequency);
+                REQUIRE(group.getResult(ch).confidence == separate[ch].getResult().confidence);
+            }
+        }
+    }
+}
+
+TEST_CASE("PitchDetectorGroup: channels fed in step share their transforms")
+{
+    const double sr = 48000.0;
+    const int numSamples = 24000;
+    std::vector<std::vector<float>> signals = { makeSine(sr, 196.0, numSamples), makeSine(sr, 261.6, numSamples),
+                                                makeSine(sr, 146.8, numSamples) };
+
+    PitchDetectorGroup group;
+    group.prepare(sr, 3);
+    feedChannels(group, signals, 32);
+    group.flushForTest();
+
+    // Three channels: two share a transform and the third is computed on its own.
+    REQUIRE(group.getNumBatchedPairs() > 0);
+
+    for (int ch = 0; ch < 3; ++ch)
+    {
+        YinPitchDetector separate;
+        separate.setSynchronous(true);
+        separate.prepare(sr);
+        separate.feedBlock(signals[static_cast<size_t>(ch)].data(), numSamples);
+
+        const auto& detector = group.getDetector(ch);
+        INFO("channel " << ch);
+        REQUIRE(detector.getNumAnalyses() == separate.getNumAnalyses());
+        REQUIRE_THAT(static_cast<double>(group.getResult(ch).frequency),
+                     Catch::Matchers::WithinRel(static_cast<double>(separate.getResult().frequency), 1e-4));
+
+        const auto& batched = detector.getDifferenceForTest();
+        const auto& expected = separate.getDifferenceForTest();
+        float peak = *std::max_element(expected.begin(), expected.end());
+        for (size_t tau = 0; tau < expected.size(); ++tau)
+            REQUIRE_THAT(batched[tau], Catch::Matchers::WithinAbs(expected[tau], 1e-4 * peak));
+    }
+}
+
+TEST_CASE("PitchDetectorGroup: one wakeup serves every channel")
+{
+    const double sr = 44100.0;
+    const int numSamples = 44100;
+    std::vector<std::vector<float>> signals(4, makeSine(sr, 220.0, numSamples));
+
+    PitchDetectorGroup group;
+    group.prepare(sr, 4);
+
+    YinPitchDetector single;
+    single.prepare(sr);
+
+    for (int offset = 0; offset < numSamples; offset += 32)
+    {
+        int count = std::min(32, numSamples - offset);
+        for (int ch = 0; ch < 4; ++ch)
+            group.feedBlock(ch, signals[static_cast<size_t>(ch)].data() + offset, count);
+        single.feedBlock(signals[0].data() + offset, count);
+    }
+    group.flushForTest();
+    single.flushForTest();
+
+    // Channels fed in step complete their hops together, so the group is woken about
+    // as often as one detector rather than once per channel.
+    REQUIRE(group.getNumWakeups() <= single.getNumWakeups() + 4);
+    for (int ch = 0; ch < 4; ++ch)
+        REQUIRE_THAT(static_cast<double>(group.getResult(ch).frequency), Catch::Matchers::WithinRel(220.0, 0.01));
+}
+
+TEST_CASE("PitchDetectorGroup: prepare keeps channels and switches mode cleanly")
+{
+    const double sr = 48000.0;
+    auto tone = makeSine(sr, 440.0, 9600);
+
+    PitchDetectorGroup group;
+    group.prepare(sr, 2);
+    group.feedBlock(0, tone.data(), 4800);
+    group.setSynchronous(true);
+    group.feedBlock(0, tone.data() + 4800, 4800);
+    REQUIRE_THAT(static_cast<double>(group.getResult(0).frequency), Catch::Matchers::WithinRel(440.0, 0.01));
+
+    group.prepare(sr, 3);
+    REQUIRE(group.getNumChannels() == 3);
+    REQUIRE(group.getResult(0).frequency == 0.0f);
+
+    group.setSynchronous(false);
+    group.feedBlock(2, tone.data(), 9600);
+    group.flushForTest();
+    REQUIRE_THAT(static_cast<double>(group.getResult(2).frequency), Catch::Matchers::WithinRel(440.0, 0.01));
+}
+
+TEST_CASE("PitchDetectorGroup: parks from a channel on, telemetry covers every channel")
+{
+    const double sr = 44100.0;
+    auto tone = makeSine(sr, 220.0, 8820);
+
+    PitchDetectorGroup group;
+    group.setSynchronous(true);
+    group.prepare(sr, 3);
+
+    for (int ch = 0; ch < 3; ++ch)
+        group.feedBlock(ch, tone.data(), 8820);
+
+    group.park(1);
+    REQUIRE_FALSE(group.getDetector(0).isParked());
+    REQUIRE(group.getDetector(1).isParked());
+    REQUIRE(group.getDetector(2).isParked());
+    REQUIRE(group.getResult(0).frequency > 0.0f);
+    REQUIRE(group.getResult(1).frequency == 0.0f);
+
+    uint32_t analyses = 0;
+    for (int ch = 0; ch < 3; ++ch)
+        analyses += group.getDetector(ch).getNumAnalyses();
+
+    auto telemetry = group.getTelemetry();
+    REQUIRE(telemetry.numAnalyses == analyses);
+    REQUIRE(telemetry.maxAnalyseMs >= group.getDetector(2).getTelemetry().maxAnalyseMs);
+    REQUIRE(telemetry.resultAgeMs >= 0.0);
+}
+
+TEST_CASE("PitchDetectorGroup: per-channel cost", "[.benchmark]")
+{
+    const double sr = 48000.0;
+    const int numSamples = 48000;
+    auto tone = makeSine(sr, 220.0, numSamples);
+
+    for (int numChannels : { 1, 2, 4 })
+    {
+        std::vector<std::vector<float>> signals(static_cast<size_t>(numChannels), tone);
+
+        BENCHMARK("group of " + std::to_string(numChannels) + ", pooled, 1 s in 512-sample blocks")
+        {
+            PitchDetectorGroup group;
+            group.setDifferenceMode(YinPitchDetector::DifferenceMode::CoarseToFine);
+            group.prepare(sr, numChannels);
+            feedChannels(group, signals, 512);
+            group.flushForTest();
+            return group.getResult(0).frequency;
+        };
+    }
+}
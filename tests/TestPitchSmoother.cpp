@@ -1,7 +1,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <juce_audio_basics/juce_audio_basics.h>
 #include "dsp/PitchSmoother.h"
+#include "dsp/Oscillator.h"
 #include <cmath>
+#include <vector>
 
 TEST_CASE("PitchSmoother: returns 0 before any valid input")
 {
@@ -208,3 +212,104 @@ TEST_CASE("PitchSmoother: stable output on sustained note")
     REQUIRE_THAT(static_cast<double>(output),
                  Catch::Matchers::WithinAbs(440.0, 0.01));
 }
+
+TEST_CASE("PitchSmoother: processBlock matches per-sample processing")
+{
+    for (int blockSize : { 16, 32, 37 })
+    {
+        DYNAMIC_SECTION("block size " << blockSize)
+        {
+            PitchSmoother perSample, block;
+            for (auto* s : { &perSample, &block })
+            {
+                s->prepare(48000.0);
+                s->setSmoothingAmount(0.4f);
+                s->setSensitivity(0.5f);
+            }
+
+            // 32 takes the precomputed coefficient, the other sizes compute their own.
+            block.setBlockSize(32);
+
+            // A slow glide within the smoothing range, then a jump that should snap.
+            // The smoothing change halfway must reach the precomputed coefficient too.
+            for (int b = 0; b < 200; ++b)
+            {
+                if (b == 100)
+                {
+                    perSample.setSmoothingAmount(0.2f);
+                    block.setSmoothingAmount(0.2f);
+                }
+
+                float freq = b < 150 ? 220.0f * std::pow(2.0f, static_cast<float>(b) / 2000.0f) : 330.0f;
+
+                float expected = 0.0f;
+                for (int i = 0; i < blockSize; ++i)
+                    expected = perSample.process(freq, 0.9f);
+
+                float actual = block.processBlock(freq, 0.9f, blockSize);
+                REQUIRE_THAT(actual, Catch::Matchers::WithinRel(expected, 1e-4f));
+            }
+        }
+    }
+}
+
+TEST_CASE("PitchSmoother: processBlock holds on low confidence")
+{
+    PitchSmoother smoother;
+    smoother.prepare(44100.0);
+    smoother.setSmoothingAmount(0.0f);
+    smoother.setSensitivity(0.5f);
+
+    REQUIRE_THAT(smoother.processBlock(440.0f, 1.0f, 32), Catch::Matchers::WithinAbs(440.0, 0.1));
+    REQUIRE_THAT(smoother.processBlock(880.0f, 0.1f, 32), Catch::Matchers::WithinAbs(440.0, 0.1));
+    REQUIRE_THAT(smoother.processBlock(0.0f, 1.0f, 32), Catch::Matchers::WithinAbs(440.0, 0.1));
+}
+
+// Carrier control path in pitch-track mode: the old per-sample loop against one
+// smoother step and one log ramp per 32-sample control block.
+TEST_CASE("PitchSmoother: control-rate carrier benchmark", "[.benchmark]")
+{
+    const int blockSize = 512;
+    const int controlBlockSize = 32;
+    std::vector<float> carrier(blockSize);
+
+    PitchSmoother smoother;
+    Oscillator osc;
+    juce::SmoothedValue<float> rateMult;
+    smoother.prepare(48000.0);
+    smoother.setSmoothingAmount(0.5f);
+    smoother.setSensitivity(0.5f);
+    smoother.setBlockSize(controlBlockSize);
+    osc.prepare(48000.0);
+    rateMult.reset(48000.0, 0.02);
+    rateMult.setCurrentAndTargetValue(1.0f);
+
+    float detected = 220.0f;
+
+    BENCHMARK("per-sample control, 512 samples")
+    {
+        detected = detected > 230.0f ? 220.0f : detected * 1.001f;
+        rateMult.setTargetValue(rateMult.getTargetValue() == 1.0f ? 1.5f : 1.0f);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            float freq = smoother.process(detected, 0.9f) * rateMult.getNextValue();
+            osc.setFrequency(freq);
+            carrier[static_cast<size_t>(i)] = osc.nextSample();
+        }
+        return carrier[0];
+    };
+
+    BENCHMARK("control-rate blocks, 512 samples")
+    {
+        detected = detected > 230.0f ? 220.0f : detected * 1.001f;
+        rateMult.setTargetValue(rateMult.getTargetValue() == 1.0f ? 1.5f : 1.0f);
+
+        for (int offset = 0; offset < blockSize; offset += controlBlockSize)
+        {
+            float freq = smoother.processBlock(detected, 0.9f, controlBlockSize) * rateMult.skip(controlBlockSize);
+            osc.renderLogRamp(carrier.data() + offset, controlBlockSize, freq);
+        }
+        return carrier[0];
+    };
+}
@@ -0,0 +1,219 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include "dsp/ProvisionalPitchEstimator.h"
+#include "dsp/PitchSmoother.h"
+#include "dsp/YinPitchDetector.h"
+#include <cmath>
+#include <random>
+#include <vector>
+
+static constexpr double twoPi = 6.283185307179586476925;
+
+static std::vector<float> makeSine(double sampleRate, double freq, int numSamples)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(twoPi * freq * i / sampleRate));
+    return out;
+}
+
+// Karplus-Strong: a noise burst through a delay line with a two-point average in
+// the loop. The average adds half a sample of delay, so the pitch is
+// sampleRate / (period + 0.5).
+static std::vector<float> makePluck(int period, int numSamples)
+{
+    std::minstd_rand rng(1234);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    std::vector<float> line(static_cast<size_t>(period));
+    for (auto& x : line)
+        x = noise(rng);
+
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    size_t pos = 0;
+    for (auto& y : out)
+    {
+        size_t next = (pos + 1) % line.size();
+        y = line[pos];
+        line[pos] = 0.498f * (line[pos] + line[next]);
+        pos = next;
+    }
+    return out;
+}
+
+// A decaying low note rich in harmonics, with a short noise click on the attack.
+static std::vector<float> makeBassHit(double sampleRate, double freq, int numSamples)
+{
+    std::minstd_rand rng(99);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    auto clickLength = static_cast<int>(sampleRate * 0.002);
+
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+    {
+        double t = i / sampleRate;
+        double phase = twoPi * freq * t;
+        double tone = std::sin(phase) + 0.5 * std::sin(2.0 * phase) + 0.3 * std::sin(3.0 * phase);
+        double click = i < clickLength ? 0.6 * noise(rng) * (1.0 - static_cast<double>(i) / clickLength) : 0.0;
+        out[static_cast<size_t>(i)] = static_cast<float>(0.4 * tone * std::exp(-t / 0.25) + click);
+    }
+    return out;
+}
+
+struct FirstPitch
+{
+    int yinSamples = -1;       // end of the first block YIN alone has the pitch
+    int carrierSamples = -1;   // the same with the provisional estimate filling in
+    bool wrongProvisional = false;
+};
+
+// Feeds the signal in 32-sample blocks, the processor's control rate. As in the
+// processor, the estimator fills in until the smoother first accepts YIN's reading.
+static FirstPitch measureFirstPitch(const std::vector<float>& signal, double sampleRate, double expected)
+{
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.prepare(sampleRate);
+
+    ProvisionalPitchEstimator estimator;
+    estimator.prepare(sampleRate);
+
+    PitchSmoother smoother;
+    smoother.prepare(sampleRate);
+    smoother.setSensitivity(0.5f);
+
+    FirstPitch first;
+    bool yinLocked = false;
+    auto numSamples = static_cast<int>(signal.size());
+    auto near = [expected](float hz) { return std::abs(hz - expected) <= expected * 0.03; };
+
+    for (int offset = 0; offset < numSamples; offset += 32)
+    {
+        int count = std::min(32, numSamples - offset);
+        yin.feedBlock(signal.data() + offset, count);
+        auto detected = yin.getResult();
+        bool yinAccepted = smoother.accepts(detected.frequency, detected.confidence);
+        yinLocked = yinLocked || yinAccepted;
+        estimator.process(signal.data() + offset, count, !yinLocked);
+
+        auto provisional = estimator.getResult();
+        bool provisionalAccepted = smoother.accepts(provisional.frequency, provisional.confidence);
+        if (provisionalAccepted && !near(provisional.frequency))
+            first.wrongProvisional = true;
+
+        if (first.yinSamples < 0 && yinAccepted && near(detected.frequency))
+            first.yinSamples = offset + count;
+
+        float carrier = yinAccepted ? detected.frequency : !yinLocked && provisionalAccepted ? provisional.frequency : 0.0f;
+        if (first.carrierSamples < 0 && near(carrier))
+            first.carrierSamples = offset + count;
+    }
+    return first;
+}
+
+TEST_CASE("ProvisionalPitchEstimator: finds steady tones within a period and a few ms")
+{
+    for (double sr : { 44100.0, 48000.0, 96000.0 })
+    {
+        for (double freq : { 82.4, 110.0, 220.0, 440.0, 1000.0 })
+        {
+            ProvisionalPitchEstimator estimator;
+            estimator.prepare(sr);
+            auto tone = makeSine(sr, freq, static_cast<int>(sr * 0.1));
+
+            int firstBlock = -1;
+            for (int offset = 0; offset < static_cast<int>(tone.size()); offset += 32)
+            {
+                estimator.process(tone.data() + offset, 32, true);
+                auto result = estimator.getResult();
+                if (result.frequency > 0.0f)
+                {
+                    INFO(sr << " Hz, " << freq << " Hz tone");
+                    REQUIRE_THAT(static_cast<double>(result.frequency), Catch::Matchers::WithinRel(freq, 0.02));
+                    if (firstBlock < 0)
+                        firstBlock = offset + 32;
+                }
+            }
+
+            INFO(sr << " Hz, " << freq << " Hz tone");
+            REQUIRE(firstBlock > 0);
+            REQUIRE(firstBlock <= static_cast<int>(sr / freq + sr * 0.006) + 32);
+        }
+    }
+}
+
+TEST_CASE("ProvisionalPitchEstimator: stays quiet on silence and noise")
+{
+    ProvisionalPitchEstimator estimator;
+    estimator.prepare(48000.0);
+
+    std::vector<float> silence(4800, 0.0f);
+    estimator.process(silence.data(), 4800, true);
+    REQUIRE(estimator.getResult().frequency == 0.0f);
+
+    std::minstd_rand rng(7);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> block(32);
+    for (int n = 0; n < 300; ++n)
+    {
+        for (auto& x : block)
+            x = noise(rng);
+        estimator.process(block.data(), 32, true);
+        REQUIRE(estimator.getResult().frequency == 0.0f);
+    }
+}
+
+TEST_CASE("ProvisionalPitchEstimator: result lasts only for the block it was asked in")
+{
+    ProvisionalPitchEstimator estimator;
+    estimator.prepare(44100.0);
+    auto tone = makeSine(44100.0, 330.0, 4410);
+
+    estimator.process(tone.data(), 4000, true);
+    REQUIRE_THAT(static_cast<double>(estimator.getResult().frequency), Catch::Matchers::WithinRel(330.0, 0.02));
+
+    estimator.process(tone.data() + 4000, 32, false);
+    REQUIRE(estimator.getResult().frequency == 0.0f);
+
+    // After a reset the old note is gone, and a new one needs its own period.
+    estimator.reset();
+    auto next = makeSine(44100.0, 110.0, 64);
+    estimator.process(next.data(), 64, true);
+    REQUIRE(estimator.getResult().frequency == 0.0f);
+}
+
+TEST_CASE("ProvisionalPitchEstimator: time to first carrier on plucked strings and bass hits")
+{
+    const double sr = 44100.0;
+
+    struct Case
+    {
+        const char* name;
+        std::vector<float> signal;
+        double expected;
+    };
+
+    std::vector<Case> cases = {
+        { "pluck G3", makePluck(224, 22050), sr / 224.5 },
+        { "pluck E4", makePluck(133, 22050), sr / 133.5 },
+        { "pluck A2", makePluck(400, 22050), sr / 400.5 },
+        { "bass hit E2", makeBassHit(sr, 82.4, 22050), 82.4 },
+        { "bass hit G2", makeBassHit(sr, 98.0, 22050), 98.0 },
+    };
+
+    for (auto& c : cases)
+    {
+        auto first = measureFirstPitch(c.signal, sr, c.expected);
+        double yinMs = 1000.0 * first.yinSamples / sr;
+        double carrierMs = 1000.0 * first.carrierSamples / sr;
+        double periodMs = 1000.0 / c.expected;
+
+        INFO(c.name << ": YIN alone " << yinMs << " ms, with the provisional estimate " << carrierMs
+                    << " ms, period " << periodMs << " ms");
+        REQUIRE(first.yinSamples > 0);
+        REQUIRE(first.carrierSamples > 0);
+        REQUIRE_FALSE(first.wrongProvisional);
+        REQUIRE(carrierMs < yinMs);
+        REQUIRE(carrierMs <= 2.0 * periodMs + 4.0);
+    }
+}
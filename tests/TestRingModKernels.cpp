@@ -0,0 +1,296 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <juce_core/juce_core.h>
+#include "dsp/RingModKernels.h"
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+// The per-sample loop the kernels replaced, kept as the reference.
+static void scalarRingMod(float* data, const float* carrier, const float* mix, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float dry = data[i];
+        float wet = dry * carrier[i];
+        data[i] = dry * (1.0f - mix[i]) + wet * mix[i];
+
+        if (!std::isfinite(data[i]))
+            data[i] = 0.0f;
+    }
+}
+
+static std::vector<float> makeSignal(int numSamples, float freq, float amplitude)
+{
+    std::vector<float> out(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        out[static_cast<size_t>(i)] = amplitude * std::sin(0.0142f * freq * static_cast<float>(i));
+    return out;
+}
+
+TEST_CASE("RingModKernels: ring mod and mix match the scalar loop")
+{
+    const int numSamples = 517;
+    auto input = makeSignal(numSamples, 3.0f, 0.8f);
+    auto carrier = makeSignal(numSamples, 17.0f, 1.0f);
+    std::vector<float> mix(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        mix[static_cast<size_t>(i)] = static_cast<float>(i) / numSamples;
+
+    auto expected = input;
+    scalarRingMod(expected.data(), carrier.data(), mix.data(), numSamples);
+
+    auto actual = input;
+    RingModKernels::applyRingMod(actual.data(), carrier.data(), mix.data(), numSamples);
+
+    for (size_t i = 0; i < expected.size(); ++i)
+        REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs(expected[i], 1e-6));
+}
+
+TEST_CASE("RingModKernels: full dry is exact and full wet is the product")
+{
+    auto input = makeSignal(64, 5.0f, 0.5f);
+    auto carrier = makeSignal(64, 11.0f, 1.0f);
+    std::vector<float> dryMix(64, 0.0f), wetMix(64, 1.0f);
+
+    auto dry = input;
+    RingModKernels::applyRingMod(dry.data(), carrier.data(), dryMix.data(), 64);
+    REQUIRE(dry == input);
+
+    auto wet = input;
+    RingModKernels::applyRingMod(wet.data(), carrier.data(), wetMix.data(), 64);
+    for (size_t i = 0; i < wet.size(); ++i)
+        REQUIRE_THAT(wet[i], Catch::Matchers::WithinAbs(input[i] * carrier[i], 1e-7));
+}
+
+TEST_CASE("RingModKernels: non-finite scan finds NaN and Inf at any position")
+{
+    const float bad[] = { std::numeric_limits<float>::quiet_NaN(),
+                          std::numeric_limits<float>::infinity(),
+                          -std::numeric_limits<float>::infinity() };
+
+    for (int length : { 1, 7, 64, 131 })
+    {
+        for (float value : bad)
+        {
+            for (int position = 0; position < length; ++position)
+            {
+                std::vector<float> data(static_cast<size_t>(length), 0.25f);
+                data[static_cast<size_t>(position)] = value;
+                REQUIRE(RingModKernels::containsNonFinite(data.data(), length));
+            }
+        }
+    }
+}
+
+TEST_CASE("RingModKernels: non-finite scan ignores extreme finite values")
+{
+    std::vector<float> data = { std::numeric_limits<float>::max(),
+                                -std::numeric_limits<float>::max(),
+                                std::numeric_limits<float>::denorm_min(),
+                                std::numeric_limits<float>::min(),
+                                -0.0f, 0.0f, 1.0f };
+
+    REQUIRE_FALSE(RingModKernels::containsNonFinite(data.data(), static_cast<int>(data.size())));
+    REQUIRE_FALSE(RingModKernels::containsNonFinite(data.data(), 0));
+}
+
+TEST_CASE("RingModKernels: ring mod reports non-finite output")
+{
+    auto input = makeSignal(100, 3.0f, 0.8f);
+    auto carrier = makeSignal(100, 17.0f, 1.0f);
+    std::vector<float> mix(100, 0.5f);
+
+    auto clean = input;
+    REQUIRE_FALSE(RingModKernels::applyRingMod(clean.data(), carrier.data(), mix.data(), 100));
+
+    auto dirty = input;
+    dirty[37] = std::numeric_limits<float>::quiet_NaN();
+    REQUIRE(RingModKernels::applyRingMod(dirty.data(), carrier.data(), mix.data(), 100));
+
+    auto overflow = input;
+    carrier[99] = std::numeric_limits<float>::infinity();
+    REQUIRE(RingModKernels::applyRingMod(overflow.data(), carrier.data(), mix.data(), 100));
+}
+
+TEST_CASE("RingModKernels: zeroNonFinite clears only the non-finite samples")
+{
+    std::vector<float> data = { 0.5f, std::numeric_limits<float>::quiet_NaN(), -0.25f,
+                                std::numeric_limits<float>::infinity(), 1.0f };
+
+    RingModKernels::zeroNonFinite(data.data(), static_cast<int>(data.size()));
+
+    REQUIRE(data == std::vector<float> { 0.5f, 0.0f, -0.25f, 0.0f, 1.0f });
+}
+
+TEST_CASE("RingModKernels: shared gain across channels matches per-channel ring mod")
+{
+    const int numSamples = 301;
+    auto carrier = makeSignal(numSamples, 17.0f, 1.0f);
+    std::vector<float> mix(static_cast<size_t>(numSamples));
+    for (int i = 0; i < numSamples; ++i)
+        mix[static_cast<size_t>(i)] = static_cast<float>(i) / numSamples;
+
+    for (int numChannels : { 1, 2, 3, 4, 5, 8, 11, 16 })
+    {
+        std::vector<std::vector<float>> expected, actual;
+        std::vector<float*> ptrs;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            expected.push_back(makeSignal(numSamples, 1.0f + static_cast<float>(ch), 0.8f));
+            RingModKernels::applyRingMod(expected.back().data(), carrier.data(), mix.data(), numSamples);
+            actual.push_back(makeSignal(numSamples, 1.0f + static_cast<float>(ch), 0.8f));
+        }
+        for (auto& channel : actual)
+            ptrs.push_back(channel.data());
+
+        auto gain = carrier;
+        RingModKernels::ringModGain(gain.data(), mix.data(), gain.data(), numSamples);
+        REQUIRE_FALSE(RingModKernels::applyGain(ptrs.data(), numChannels, gain.data(), numSamples));
+
+        INFO(numChannels << " channels");
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("RingModKernels: shared gain reports non-finite output on any channel")
+{
+    std::vector<float> gain(64, 0.5f);
+
+    for (int bad : { 0, 3, 4, 6 })
+    {
+        std::vector<std::vector<float>> channels(7, std::vector<float>(64, 0.25f));
+        channels[static_cast<size_t>(bad)][40] = std::numeric_limits<float>::quiet_NaN();
+
+        std::vector<float*> ptrs;
+        for (auto& channel : channels)
+            ptrs.push_back(channel.data());
+
+        INFO("NaN on channel " << bad);
+        REQUIRE(RingModKernels::applyGain(ptrs.data(), 7, gain.data(), 64));
+    }
+}
+
+TEST_CASE("RingModKernels: double buffers take the float gain without narrowing")
+{
+    const int numSamples = 77;
+    auto carrier = makeSignal(numSamples, 5.0f, 1.0f);
+    std::vector<float> gain(static_cast<size_t>(numSamples));
+    std::vector<float> mix(static_cast<size_t>(numSamples), 0.6f);
+    RingModKernels::ringModGain(carrier.data(), mix.data(), gain.data(), numSamples);
+
+    for (int numChannels : { 1, 4, 6 })
+    {
+        std::vector<std::vector<double>> channels;
+        std::vector<double*> ptrs;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            channels.emplace_back(static_cast<size_t>(numSamples));
+            for (int i = 0; i < numSamples; ++i)
+                channels.back()[static_cast<size_t>(i)] = 0.1 + 1.0e-12 * (i + ch);
+        }
+        for (auto& channel : channels)
+            ptrs.push_back(channel.data());
+
+        REQUIRE_FALSE(RingModKernels::applyGain(ptrs.data(), numChannels, gain.data(), numSamples));
+
+        INFO(numChannels << " channels");
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < numSamples; ++i)
+                REQUIRE(channels[static_cast<size_t>(ch)][static_cast<size_t>(i)]
+                        == (0.1 + 1.0e-12 * (i + ch)) * static_cast<double>(gain[static_cast<size_t>(i)]));
+    }
+
+    std::vector<double> dirty(32, 0.25);
+    dirty[9] = std::numeric_limits<double>::infinity();
+    dirty[20] = 1.0e300;
+    REQUIRE(RingModKernels::applyGain(dirty.data(), std::vector<float>(32, 1.0e10f).data(), 32) != 0);
+    RingModKernels::zeroNonFinite(dirty.data(), 32);
+    REQUIRE(dirty[9] == 0.0);
+    REQUIRE(dirty[20] == 0.0);
+    REQUIRE(dirty[0] == 0.25 * 1.0e10);
+}
+
+TEST_CASE("RingModKernels: silence check honours the threshold and never passes NaN or Inf")
+{
+    std::vector<float> quiet(100, 0.0f);
+    quiet[17] = -1.0e-6f;
+    quiet[50] = 1.0e-40f;
+    REQUIRE(RingModKernels::isSilent(quiet.data(), 100, 1.0e-6f));
+    REQUIRE_FALSE(RingModKernels::isSilent(quiet.data(), 100, 0.0f));
+    REQUIRE(RingModKernels::isSilent(quiet.data(), 0, 0.0f));
+
+    for (float bad : { 2.0e-6f, -0.5f, std::numeric_limits<float>::quiet_NaN(),
+                       -std::numeric_limits<float>::infinity() })
+    {
+        auto data = quiet;
+        data[99] = bad;
+        INFO(bad);
+        REQUIRE_FALSE(RingModKernels::isSilent(data.data(), 100, 1.0e-6f));
+    }
+
+    std::vector<double> wide(64, 1.0e-9);
+    REQUIRE(RingModKernels::isSilent(wide.data(), 64, 1.0e-6));
+    wide[3] = std::numeric_limits<double>::quiet_NaN();
+    REQUIRE_FALSE(RingModKernels::isSilent(wide.data(), 64, 1.0e-6));
+}
+
+TEST_CASE("RingModKernels: benchmarks against the scalar loop", "[.benchmark]")
+{
+    for (int blockSize : { 64, 128, 256, 512, 1024 })
+    {
+        auto input = makeSignal(blockSize, 3.0f, 0.8f);
+        auto carrier = makeSignal(blockSize, 17.0f, 1.0f);
+        std::vector<float> mix(static_cast<size_t>(blockSize), 0.7f);
+        auto data = input;
+
+        // Repeated runs decay the buffer towards zero; flush denormals as processBlock does.
+        juce::ScopedNoDenormals noDenormals;
+
+        BENCHMARK("scalar loop, " + std::to_string(blockSize) + " samples")
+        {
+            scalarRingMod(data.data(), carrier.data(), mix.data(), blockSize);
+            return data[0];
+        };
+
+        data = input;
+        BENCHMARK("kernels, " + std::to_string(blockSize) + " samples")
+        {
+            if (RingModKernels::applyRingMod(data.data(), carrier.data(), mix.data(), blockSize))
+                RingModKernels::zeroNonFinite(data.data(), blockSize);
+            return data[0];
+        };
+    }
+}
+
+TEST_CASE("RingModKernels: shared gain scales with channel count", "[.benchmark]")
+{
+    const int blockSize = 512;
+    auto carrier = makeSignal(blockSize, 17.0f, 1.0f);
+    std::vector<float> mix(static_cast<size_t>(blockSize), 0.7f), gain(static_cast<size_t>(blockSize));
+    juce::ScopedNoDenormals noDenormals;
+
+    for (int numChannels : { 1, 2, 4, 8, 16 })
+    {
+        std::vector<std::vector<float>> channels(static_cast<size_t>(numChannels), makeSignal(blockSize, 3.0f, 0.8f));
+        std::vector<float*> ptrs;
+        for (auto& channel : channels)
+            ptrs.push_back(channel.data());
+
+        BENCHMARK("per-channel ring mod, " + std::to_string(numChannels) + " channels")
+        {
+            for (auto* channel : ptrs)
+                RingModKernels::applyRingMod(channel, carrier.data(), mix.data(), blockSize);
+            return ptrs[0][0];
+        };
+
+        BENCHMARK("shared gain, " + std::to_string(numChannels) + " channels")
+        {
+            RingModKernels::ringModGain(carrier.data(), mix.data(), gain.data(), blockSize);
+            RingModKernels::applyGain(ptrs.data(), numChannels, gain.data(), blockSize);
+            return ptrs[0][0];
+        };
+    }
+}
@@ -1,7 +1,11 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include "dsp/YinPitchDetector.h"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 static constexpr double twoPi = 6.283185307179586476925;
 static constexpr int decimationFactor = 2;
@@ -81,6 +85,7 @@ static int feedSineUntilDetection(YinPitchDetector& yin, double sampleRate, floa
 TEST_CASE("YIN: detects 440 Hz sine at 44100 Hz")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 440.0f, 44100);
@@ -95,6 +100,7 @@ TEST_CASE("YIN: detects 440 Hz sine at 44100 Hz")
 TEST_CASE("YIN: detects 220 Hz sine at 44100 Hz")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 220.0f, 44100);
@@ -109,6 +115,7 @@ TEST_CASE("YIN: detects 220 Hz sine at 44100 Hz")
 TEST_CASE("YIN: parabolic interpolation is accurate for 110 Hz sine")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 110.0f, 44100);
@@ -123,6 +130,7 @@ TEST_CASE("YIN: parabolic interpolation is accurate for 110 Hz sine")
 TEST_CASE("YIN: detects E2 (82.4 Hz) at 44100 Hz")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 82.4f, 44100);
@@ -136,6 +144,7 @@ TEST_CASE("YIN: detects E2 (82.4 Hz) at 44100 Hz")
 TEST_CASE("YIN: detects 880 Hz sine at 48000 Hz")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(48000.0);
 
     feedSine(yin, 48000.0, 880.0f, 48000);
@@ -150,6 +159,7 @@ TEST_CASE("YIN: detects 880 Hz sine at 48000 Hz")
 TEST_CASE("YIN: detects pitch at 96000 Hz sample rate")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(96000.0);
 
     feedSine(yin, 96000.0, 440.0f, 96000);
@@ -164,6 +174,7 @@ TEST_CASE("YIN: detects pitch at 96000 Hz sample rate")
 TEST_CASE("YIN: returns zero for silence")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     for (int i = 0; i < 44100; ++i)
@@ -177,6 +188,7 @@ TEST_CASE("YIN: returns zero for silence")
 TEST_CASE("YIN: prepare resets state")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 440.0f, 44100);
@@ -189,6 +201,7 @@ TEST_CASE("YIN: prepare resets state")
 TEST_CASE("YIN: rejects out-of-range frequencies")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 10.0f, 44100);
@@ -200,6 +213,7 @@ TEST_CASE("YIN: rejects out-of-range frequencies")
 TEST_CASE("YIN: confidence is clamped to [0, 1]")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 440.0f, 44100);
@@ -212,6 +226,7 @@ TEST_CASE("YIN: confidence is clamped to [0, 1]")
 TEST_CASE("YIN: first detection within one window fill")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     int winOriginal = computeWindowSize(44100.0) * decimationFactor;
@@ -225,6 +240,7 @@ TEST_CASE("YIN: first detection within one window fill")
 TEST_CASE("YIN: first 440 Hz detection is under 20 ms")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 440.0f, 882);
@@ -238,6 +254,7 @@ TEST_CASE("YIN: first 440 Hz detection is under 20 ms")
 TEST_CASE("YIN: locks to 440 Hz within 20 ms after silence")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     for (int i = 0; i < 44100; ++i)
@@ -257,6 +274,7 @@ TEST_CASE("YIN: locks to 440 Hz within 20 ms after silence")
 TEST_CASE("YIN: detects E2 within 30 ms")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 82.4f, 1323);
@@ -270,6 +288,7 @@ TEST_CASE("YIN: detects E2 within 30 ms")
 TEST_CASE("YIN: detects pitch change after silence")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     int winOriginal = computeWindowSize(44100.0) * decimationFactor;
@@ -294,6 +313,7 @@ TEST_CASE("YIN: detects pitch change after silence")
 TEST_CASE("YIN: tracks frequency sweep across hop intervals")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     int winOriginal = computeWindowSize(44100.0) * decimationFactor;
@@ -316,6 +336,7 @@ TEST_CASE("YIN: tracks frequency sweep across hop intervals")
 TEST_CASE("YIN: fallback detects harmonically complex low signal")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedHarmonicComplex(yin, 44100.0, 82.4f, 44100, 0.15f);
@@ -329,6 +350,7 @@ TEST_CASE("YIN: fallback detects harmonically complex low signal")
 TEST_CASE("YIN: silence still returns zero with fallback")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     for (int i = 0; i < 44100; ++i)
@@ -343,6 +365,7 @@ TEST_CASE("YIN: silence still returns zero with fallback")
 TEST_CASE("YIN: threshold path still preferred for clean signals")
 {
     YinPitchDetector yin;
+    yin.setSynchronous(true);
     yin.prepare(44100.0);
 
     feedSine(yin, 44100.0, 440.0f, 44100);
@@ -352,3 +375,743 @@ TEST_CASE("YIN: threshold path still preferred for clean signals")
     REQUIRE_THAT(static_cast<double>(result.frequency),
                  Catch::Matchers::WithinRel(440.0, 0.01));
 }
+
+TEST_CASE("YIN: feedBlock detects 440 Hz sine fed in host-sized blocks")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+
+    constexpr int blockSize = 128;
+    std::vector<float> block(blockSize);
+    double phase = 0.0;
+    double inc = twoPi * 440.0 / 44100.0;
+
+    for (int fed = 0; fed < 44100; fed += blockSize)
+    {
+        for (auto& s : block)
+        {
+            s = static_cast<float>(std::sin(phase));
+            phase += inc;
+        }
+        REQUIRE(yin.feedBlock(block.data(), blockSize) == 0);
+    }
+    yin.flushForTest();
+
+    auto result = yin.getResult();
+    REQUIRE(result.frequency > 0.0f);
+    REQUIRE_THAT(static_cast<double>(result.frequency),
+                 Catch::Matchers::WithinRel(440.0, 0.01));
+}
+
+TEST_CASE("YIN: feedBlock reports samples dropped when the FIFO is full")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+
+    constexpr int oversized = 200000;
+    std::vector<float> block(oversized, 0.0f);
+
+    int dropped = yin.feedBlock(block.data(), oversized);
+    REQUIRE(dropped > 0);
+    REQUIRE(dropped < oversized);
+
+    yin.flushForTest();
+    REQUIRE(yin.feedBlock(block.data(), 512) == 0);
+}
+
+TEST_CASE("YIN: analysis pool is woken at most once per hop")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+
+    constexpr int blockSize = 32;
+    constexpr int numSamples = 44100;
+    std::vector<float> block(blockSize);
+    double phase = 0.0;
+    double inc = twoPi * 220.0 / 44100.0;
+
+    for (int fed = 0; fed < numSamples; fed += blockSize)
+    {
+        for (auto& s : block)
+        {
+            s = static_cast<float>(std::sin(phase));
+            phase += inc;
+        }
+        yin.feedBlock(block.data(), blockSize);
+    }
+    yin.flushForTest();
+
+    int hopOriginal = computeHopSize(44100.0) * decimationFactor;
+    REQUIRE(yin.getNumWakeups() <= static_cast<uint32_t>(numSamples / hopOriginal + 2));
+    REQUIRE_THAT(static_cast<double>(yin.getResult().frequency),
+                 Catch::Matchers::WithinRel(220.0, 0.01));
+}
+
+TEST_CASE("YIN: silence wakes the analysis pool less often than once per hop")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+
+    constexpr int blockSize = 32;
+    constexpr int numSamples = 44100;
+    std::vector<float> block(blockSize, 0.0f);
+
+    for (int fed = 0; fed < numSamples; fed += blockSize)
+        yin.feedBlock(block.data(), blockSize);
+    yin.flushForTest();
+
+    int hopOriginal = computeHopSize(44100.0) * decimationFactor;
+    REQUIRE(yin.getNumWakeups() < static_cast<uint32_t>(numSamples / hopOriginal / 2));
+    REQUIRE(yin.getResult().frequency == 0.0f);
+}
+
+TEST_CASE("YIN: a short feedSilence is analysed as zeros")
+{
+    YinPitchDetector fedZeros, fedSilence;
+    for (auto* yin : { &fedZeros, &fedSilence })
+    {
+        yin->setSynchronous(true);
+        yin->prepare(44100.0);
+        feedSine(*yin, 44100.0, 330.0f, 8820);
+    }
+
+    std::vector<float> zeros(2000, 0.0f);
+    fedZeros.feedBlock(zeros.data(), 2000);
+    fedSilence.feedSilence(2000);
+    REQUIRE_FALSE(fedSilence.isParked());
+
+    feedSine(fedZeros, 44100.0, 440.0f, 4410);
+    feedSine(fedSilence, 44100.0, 440.0f, 4410);
+    REQUIRE(fedSilence.getResult().frequency == fedZeros.getResult().frequency);
+    REQUIRE(fedSilence.getResult().confidence == fedZeros.getResult().confidence);
+}
+
+TEST_CASE("YIN: long silence parks the detector and stops waking the pool")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+    feedSine(yin, 44100.0, 440.0f, 22050);
+    REQUIRE(yin.getResult().frequency > 0.0f);
+
+    for (int fed = 0; fed < 44100; fed += 512)
+        yin.feedSilence(512);
+    yin.flushForTest();
+
+    REQUIRE(yin.isParked());
+    REQUIRE(yin.getResult().frequency == 0.0f);
+
+    auto wakeups = yin.getNumWakeups();
+    for (int fed = 0; fed < 441000; fed += 512)
+        yin.feedSilence(512);
+    yin.flushForTest();
+    REQUIRE(yin.getNumWakeups() == wakeups);
+
+    feedSine(yin, 44100.0, 220.0f, 4410);
+    REQUIRE_FALSE(yin.isParked());
+    REQUIRE_THAT(static_cast<double>(yin.getResult().frequency), Catch::Matchers::WithinRel(220.0, 0.03));
+}
+
+TEST_CASE("YIN: reacquires after a parked silence as fast as from cold")
+{
+    for (bool synchronous : { false, true })
+    {
+        YinPitchDetector cold;
+        cold.setSynchronous(synchronous);
+        cold.prepare(44100.0);
+        int coldSamples = feedSineUntilDetection(cold, 44100.0, 440.0f, 44100);
+
+        YinPitchDetector parked;
+        parked.setSynchronous(synchronous);
+        parked.prepare(44100.0);
+        feedSine(parked, 44100.0, 330.0f, 22050);
+        parked.feedSilence(44100);
+        parked.flushForTest();
+        int parkedSamples = feedSineUntilDetection(parked, 44100.0, 440.0f, 44100);
+
+        INFO((synchronous ? "synchronous" : "pooled"));
+        REQUIRE(parkedSamples == coldSamples);
+        REQUIRE_THAT(static_cast<double>(parked.getResult().frequency), Catch::Matchers::WithinRel(440.0, 0.03));
+    }
+}
+
+TEST_CASE("YIN: sliding difference function matches batch within tolerance")
+{
+    const double sr = 44100.0;
+    YinPitchDetector batch, sliding;
+    batch.setSynchronous(true);
+    sliding.setSynchronous(true);
+    sliding.setDifferenceMode(YinPitchDetector::DifferenceMode::Sliding);
+
+    // A fixed 3 ms hop, so every analysis is a slide or a resync and both detectors
+    // analyse at the same positions.
+    batch.setMaxHopSeconds(0.003);
+    sliding.setMaxHopSeconds(0.003);
+    batch.prepare(sr);
+    sliding.prepare(sr);
+
+    // Vibrato and a slow swell so every hop actually changes the difference function.
+    double phase = 0.0;
+    std::vector<float> block(1000);
+
+    for (int checkpoint = 0; checkpoint < 8; ++checkpoint)
+    {
+        for (int b = 0; b < 11; ++b)
+        {
+            for (auto& sample : block)
+            {
+                double t = phase / twoPi / 150.0;
+                double s = std::sin(phase) + 0.6 * std::sin(2.0 * phase) + 0.3 * std::sin(3.0 * phase);
+                sample = static_cast<float>(s * (0.3 + 0.2 * std::sin(t)));
+                phase += twoPi * 150.0 * (1.0 + 0.02 * std::sin(t * 0.7)) / sr;
+            }
+            batch.feedBlock(block.data(), static_cast<int>(block.size()));
+            sliding.feedBlock(block.data(), static_cast<int>(block.size()));
+        }
+        batch.flushForTest();
+        sliding.flushForTest();
+
+        const auto& expected = batch.getDifferenceForTest();
+        const auto& actual = sliding.getDifferenceForTest();
+        REQUIRE(expected.size() == actual.size());
+
+        float peak = 0.0f, worst = 0.0f;
+        for (size_t tau = 0; tau < expected.size(); ++tau)
+        {
+            peak = std::max(peak, std::abs(expected[tau]));
+            worst = std::max(worst, std::abs(expected[tau] - actual[tau]));
+        }
+
+        INFO("checkpoint " << checkpoint << ": worst " << worst << " of peak " << peak);
+        REQUIRE(peak > 0.0f);
+        REQUIRE(worst < peak * 1e-4f);
+
+        auto a = batch.getResult();
+        auto b = sliding.getResult();
+        REQUIRE_THAT(b.frequency, Catch::Matchers::WithinAbs(a.frequency, a.frequency * 1e-3f));
+        REQUIRE_THAT(b.confidence, Catch::Matchers::WithinAbs(a.confidence, 1e-3f));
+    }
+
+    // 88000 samples at a 67-sample decimated hop is about 660 analyses; all but the
+    // first few after the window filled, and one in every 32, should have slid.
+    auto analyses = sliding.getNumAnalyses();
+    INFO(sliding.getNumSlides() << " slides and " << sliding.getNumResyncs() << " resyncs in " << analyses << " analyses");
+    REQUIRE(analyses == batch.getNumAnalyses());
+    REQUIRE(sliding.getNumSlides() > analyses * 9 / 10);
+    REQUIRE(sliding.getNumResyncs() >= analyses / 33);
+    REQUIRE(batch.getNumSlides() == 0);
+}
+
+TEST_CASE("YIN: sliding still runs under the adaptive hop")
+{
+    const double sr = 44100.0;
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.setDifferenceMode(YinPitchDetector::DifferenceMode::Sliding);
+    yin.prepare(sr);
+
+    // A steady tone stretches the hop, and stretched hops are recomputed; the
+    // vibrato section keeps it at 3 ms, where the difference function slides.
+    feedSine(yin, sr, 220.0f, 22050);
+    auto slidesWhileSteady = yin.getNumSlides();
+
+    double phase = 0.0;
+    std::vector<float> vibrato(22050);
+    for (size_t i = 0; i < vibrato.size(); ++i)
+    {
+        double t = static_cast<double>(i) / sr;
+        vibrato[i] = static_cast<float>(0.5 * std::sin(phase));
+        phase += twoPi * 220.0 * (1.0 + 0.03 * std::sin(twoPi * 6.0 * t)) / sr;
+    }
+    yin.feedBlock(vibrato.data(), static_cast<int>(vibrato.size()));
+
+    INFO(slidesWhileSteady << " slides while steady, " << yin.getNumSlides() << " in total");
+    REQUIRE(yin.getNumSlides() > slidesWhileSteady + 30);
+    REQUIRE(yin.getNumResyncs() > 0);
+}
+
+TEST_CASE("YIN: sliding mode recovers after silence")
+{
+    const double sr = 48000.0;
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.setDifferenceMode(YinPitchDetector::DifferenceMode::Sliding);
+    yin.prepare(sr);
+
+    feedSine(yin, sr, 330.0f, 24000);
+    REQUIRE_THAT(yin.getResult().frequency, Catch::Matchers::WithinAbs(330.0, 2.0));
+
+    for (int i = 0; i < 24000; ++i)
+        yin.feedSample(0.0f);
+    yin.flushForTest();
+    REQUIRE(yin.getResult().frequency == 0.0f);
+
+    feedSine(yin, sr, 196.0f, 24000);
+    REQUIRE_THAT(yin.getResult().frequency, Catch::Matchers::WithinAbs(196.0, 2.0));
+}
+
+static double analysesPerSecond(YinPitchDetector& yin, double sampleRate, const std::vector<float>& signal)
+{
+    for (size_t offset = 0; offset < signal.size(); offset += 256)
+    {
+        int count = static_cast<int>(std::min<size_t>(256, signal.size() - offset));
+        yin.feedBlock(signal.data() + offset, count);
+        yin.flushForTest();
+    }
+    return yin.getNumAnalyses() * sampleRate / static_cast<double>(signal.size());
+}
+
+static std::vector<float> makeLegatoLine(double sampleRate, const std::vector<float>& notes, double noteSeconds)
+{
+    std::vector<float> signal;
+    double phase = 0.0;
+    auto noteLength = static_cast<int>(sampleRate * noteSeconds);
+
+    for (float freq : notes)
+    {
+        for (int i = 0; i < noteLength; ++i)
+        {
+            double s = std::sin(phase) + 0.5 * std::sin(2.0 * phase) + 0.25 * std::sin(3.0 * phase);
+            signal.push_back(static_cast<float>(0.4 * s));
+            phase += twoPi * static_cast<double>(freq) / sampleRate;
+        }
+    }
+    return signal;
+}
+
+TEST_CASE("YIN: adaptive hop reduces analyses on sustained and legato material")
+{
+    const double sr = 44100.0;
+    auto sustained = makeLegatoLine(sr, { 98.0f }, 2.0);
+    auto legato = makeLegatoLine(sr, { 110.0f, 146.8f, 123.5f, 164.8f, 98.0f, 130.8f, 110.0f, 82.4f }, 0.25);
+
+    YinPitchDetector fixedHop, adaptive;
+    fixedHop.setSynchronous(true);
+    adaptive.setSynchronous(true);
+    fixedHop.setMaxHopSeconds(0.003);
+    fixedHop.prepare(sr);
+    adaptive.prepare(sr);
+
+    double fixedSustained = analysesPerSecond(fixedHop, sr, sustained);
+    double adaptiveSustained = analysesPerSecond(adaptive, sr, sustained);
+    fixedHop.prepare(sr);
+    adaptive.prepare(sr);
+    double fixedLegato = analysesPerSecond(fixedHop, sr, legato);
+    double adaptiveLegato = analysesPerSecond(adaptive, sr, legato);
+
+    INFO("sustained: fixed " << fixedSustained << "/s, adaptive " << adaptiveSustained << "/s");
+    INFO("legato: fixed " << fixedLegato << "/s, adaptive " << adaptiveLegato << "/s");
+    CHECK(fixedSustained > 300.0);
+    CHECK(adaptiveSustained < fixedSustained / 3.0);
+    CHECK(adaptiveLegato < fixedLegato / 2.0);
+}
+
+TEST_CASE("YIN: adaptive hop snaps back on legato note changes")
+{
+    const double sr = 44100.0;
+    std::vector<float> notes = { 110.0f, 146.8f, 123.5f, 164.8f, 98.0f };
+    auto legato = makeLegatoLine(sr, notes, 0.25);
+    auto noteLength = static_cast<size_t>(sr * 0.25);
+    auto settle = static_cast<size_t>(sr * 0.03);
+
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.prepare(sr);
+
+    for (size_t note = 0; note < notes.size(); ++note)
+    {
+        size_t begin = note * noteLength;
+        yin.feedBlock(legato.data() + begin, static_cast<int>(settle));
+        yin.flushForTest();
+
+        INFO("note " << note << " at " << notes[note] << " Hz");
+        REQUIRE_THAT(yin.getResult().frequency, Catch::Matchers::WithinRel(notes[note], 0.01f));
+
+        yin.feedBlock(legato.data() + begin + settle, static_cast<int>(noteLength - settle));
+        yin.flushForTest();
+    }
+}
+
+TEST_CASE("YIN: adaptive hop reacts to a level change within one minimum hop")
+{
+    const double sr = 44100.0;
+    const double maxDelayMs = 1000.0 * hopSeconds;
+    auto quiet = makeLegatoLine(sr, { 220.0f }, 1.0);
+    for (auto& s : quiet)
+        s *= 0.05f;
+    auto loud = makeLegatoLine(sr, { 220.0f }, 0.05);
+
+    // Feeds one sample at a time from offset and returns how many went in before an
+    // analysis ran, or -1 if none did.
+    auto samplesToNextAnalysis = [](YinPitchDetector& yin, const std::vector<float>& signal, size_t offset)
+    {
+        auto before = yin.getNumAnalyses();
+        for (size_t i = offset; i < signal.size(); ++i)
+        {
+            yin.feedSample(signal[i]);
+            if (yin.getNumAnalyses() != before)
+                return static_cast<int>(i - offset + 1);
+        }
+        return -1;
+    };
+
+    // The step lands this far into a stretched hop, counted from the last analysis.
+    for (double stepMs : { 0.5, 2.0, 4.0, 7.0, 10.0 })
+    {
+        YinPitchDetector yin, control;
+        for (auto* d : { &yin, &control })
+        {
+            d->setSynchronous(true);
+            d->prepare(sr);
+        }
+
+        auto settle = static_cast<size_t>(sr * 0.5);
+        auto stepOffset = static_cast<size_t>(sr * stepMs / 1000.0);
+        size_t position = 0;
+        for (auto* d : { &yin, &control })
+        {
+            d->feedBlock(quiet.data(), static_cast<int>(settle));
+            position = settle + static_cast<size_t>(samplesToNextAnalysis(*d, quiet, settle));
+            d->feedBlock(quiet.data() + position, static_cast<int>(stepOffset));
+        }
+        position += stepOffset;
+
+        // Without the step the stretched hop runs well past one minimum hop.
+        int controlDelay = samplesToNextAnalysis(control, quiet, position);
+        int stepDelay = samplesToNextAnalysis(yin, loud, 0);
+
+        double controlMs = 1000.0 * controlDelay / sr;
+        double stepDelayMs = 1000.0 * stepDelay / sr;
+        INFO("step " << stepMs << " ms into the hop: next analysis " << stepDelayMs
+                     << " ms later, " << controlMs << " ms without it");
+        REQUIRE(controlMs + stepMs > 2.0 * maxDelayMs);
+        REQUIRE(stepDelay > 0);
+        REQUIRE(stepDelayMs <= maxDelayMs);
+    }
+}
+
+TEST_CASE("YIN: coarse-to-fine search matches the full search")
+{
+    const double rates[] = { 44100.0, 48000.0, 96000.0 };
+    const float freqs[] = { 82.4f, 110.0f, 196.0f, 440.0f, 1000.0f, 2500.0f };
+
+    for (double sr : rates)
+    {
+        for (float freq : freqs)
+        {
+            for (bool harmonic : { false, true })
+            {
+                DYNAMIC_SECTION(sr << " Hz, " << freq << " Hz" << (harmonic ? " harmonic" : " sine"))
+                {
+                    YinPitchDetector full, coarse;
+                    full.setSynchronous(true);
+                    coarse.setSynchronous(true);
+                    coarse.setDifferenceMode(YinPitchDetector::DifferenceMode::CoarseToFine);
+                    full.prepare(sr);
+                    coarse.prepare(sr);
+
+                    if (harmonic)
+                    {
+                        feedHarmonicComplex(full, sr, freq, static_cast<int>(sr / 2), 0.3f);
+                        feedHarmonicComplex(coarse, sr, freq, static_cast<int>(sr / 2), 0.3f);
+                    }
+                    else
+                    {
+                        feedSine(full, sr, freq, static_cast<int>(sr / 2));
+                        feedSine(coarse, sr, freq, static_cast<int>(sr / 2));
+                    }
+
+                    auto expected = full.getResult();
+                    auto actual = coarse.getResult();
+                    REQUIRE(expected.frequency > 0.0f);
+                    REQUIRE_THAT(actual.frequency, Catch::Matchers::WithinRel(expected.frequency, 1e-4f));
+                    REQUIRE_THAT(actual.confidence, Catch::Matchers::WithinAbs(expected.confidence, 1e-3f));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("YIN: coarse-to-fine keeps 110 Hz parabolic accuracy and E2 detection")
+{
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.setDifferenceMode(YinPitchDetector::DifferenceMode::CoarseToFine);
+    yin.prepare(44100.0);
+
+    feedSine(yin, 44100.0, 110.0f, 44100);
+    REQUIRE_THAT(static_cast<double>(yin.getResult().frequency), Catch::Matchers::WithinAbs(110.0, 0.2));
+
+    yin.prepare(44100.0);
+    feedSine(yin, 44100.0, 82.4f, 44100);
+    REQUIRE_THAT(static_cast<double>(yin.getResult().frequency), Catch::Matchers::WithinRel(82.4, 0.03));
+}
+
+static std::vector<PitchResult> trackInBlocks(YinPitchDetector& yin, const std::vector<float>& signal,
+                                              int blockSize, int snapshotInterval)
+{
+    std::vector<PitchResult> snapshots;
+
+    for (size_t offset = 0; offset < signal.size(); offset += static_cast<size_t>(blockSize))
+    {
+        int count = static_cast<int>(std::min<size_t>(static_cast<size_t>(blockSize), signal.size() - offset));
+        yin.feedBlock(signal.data() + offset, count);
+
+        if ((offset + static_cast<size_t>(count)) % static_cast<size_t>(snapshotInterval) == 0)
+            snapshots.push_back(yin.getResult());
+    }
+    return snapshots;
+}
+
+static bool sameResults(const std::vector<PitchResult>& a, const std::vector<PitchResult>& b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const PitchResult& x, const PitchResult& y)
+    {
+        return x.frequency == y.frequency && x.confidence == y.confidence;
+    });
+}
+
+TEST_CASE("YIN: synchronous results are identical across runs and block sizes")
+{
+    const double sr = 44100.0;
+    auto legato = makeLegatoLine(sr, { 110.0f, 146.8f, 123.5f, 164.8f, 98.0f }, 0.2);
+
+    YinPitchDetector first, second, otherBlocks;
+    for (auto* yin : { &first, &second, &otherBlocks })
+    {
+        yin->setSynchronous(true);
+        yin->setDifferenceMode(YinPitchDetector::DifferenceMode::CoarseToFine);
+        yin->prepare(sr);
+    }
+
+    auto a = trackInBlocks(first, legato, 64, 192);
+    auto b = trackInBlocks(second, legato, 64, 192);
+    auto c = trackInBlocks(otherBlocks, legato, 192, 192);
+
+    REQUIRE(a.size() > 100);
+    REQUIRE(sameResults(a, b));
+    REQUIRE(sameResults(a, c));
+    REQUIRE(first.getNumAnalyses() == otherBlocks.getNumAnalyses());
+    REQUIRE(first.getNumWakeups() == 0);
+}
+
+TEST_CASE("YIN: synchronous and pooled analysis agree once flushed")
+{
+    const double sr = 48000.0;
+    auto legato = makeLegatoLine(sr, { 196.0f, 220.0f, 261.6f }, 0.3);
+
+    YinPitchDetector pooled, synchronous;
+    synchronous.setSynchronous(true);
+    pooled.prepare(sr);
+    synchronous.prepare(sr);
+
+    for (size_t offset = 0; offset < legato.size(); offset += 480)
+    {
+        int count = static_cast<int>(std::min<size_t>(480, legato.size() - offset));
+        pooled.feedBlock(legato.data() + offset, count);
+        synchronous.feedBlock(legato.data() + offset, count);
+        pooled.flushForTest();
+
+        REQUIRE(pooled.getResult().frequency == synchronous.getResult().frequency);
+        REQUIRE(pooled.getResult().confidence == synchronous.getResult().confidence);
+    }
+
+    REQUIRE(pooled.getNumAnalyses() == synchronous.getNumAnalyses());
+}
+
+TEST_CASE("YIN: double input is analysed as its float rounding")
+{
+    const double sr = 44100.0;
+    auto legato = makeLegatoLine(sr, { 110.0f, 146.8f, 123.5f }, 0.2);
+
+    // Doubles that round to the float signal, but are not equal to it.
+    std::vector<double> wide(legato.size());
+    for (size_t i = 0; i < legato.size(); ++i)
+        wide[i] = static_cast<double>(legato[i]) * (1.0 + 1e-10);
+
+    for (bool synchronous : { true, false })
+    {
+        YinPitchDetector narrow, direct;
+        for (auto* yin : { &narrow, &direct })
+        {
+            yin->setSynchronous(synchronous);
+            yin->prepare(sr);
+        }
+
+        // Blocks longer than the synchronous path's narrowing chunk.
+        for (size_t offset = 0; offset < legato.size(); offset += 700)
+        {
+            int count = static_cast<int>(std::min<size_t>(700, legato.size() - offset));
+            narrow.feedBlock(legato.data() + offset, count);
+            direct.feedBlock(wide.data() + offset, count);
+            narrow.flushForTest();
+            direct.flushForTest();
+
+            INFO((synchronous ? "synchronous" : "pooled") << ", offset " << offset);
+            REQUIRE(direct.getResult().frequency == narrow.getResult().frequency);
+            REQUIRE(direct.getResult().confidence == narrow.getResult().confidence);
+        }
+
+        REQUIRE(direct.getNumAnalyses() == narrow.getNumAnalyses());
+    }
+}
+
+TEST_CASE("YIN: switching to synchronous mid-stream keeps the queued input")
+{
+    const double sr = 44100.0;
+    auto legato = makeLegatoLine(sr, { 110.0f, 146.8f }, 0.3);
+    auto half = legato.size() / 2;
+
+    YinPitchDetector switched, reference;
+    reference.setSynchronous(true);
+    switched.prepare(sr);
+    reference.prepare(sr);
+
+    switched.feedBlock(legato.data(), static_cast<int>(half));
+    switched.setSynchronous(true);
+    switched.feedBlock(legato.data() + half, static_cast<int>(legato.size() - half));
+    reference.feedBlock(legato.data(), static_cast<int>(legato.size()));
+
+    REQUIRE(switched.getNumAnalyses() == reference.getNumAnalyses());
+    REQUIRE(switched.getResult().frequency == reference.getResult().frequency);
+    REQUIRE_THAT(static_cast<double>(switched.getResult().frequency), Catch::Matchers::WithinRel(146.8, 0.01));
+
+    switched.setSynchronous(false);
+    switched.feedBlock(legato.data(), static_cast<int>(half));
+    switched.flushForTest();
+    REQUIRE_THAT(static_cast<double>(switched.getResult().frequency), Catch::Matchers::WithinRel(110.0, 0.01));
+}
+
+TEST_CASE("YIN: synchronous feedBlock never drops input")
+{
+    YinPitchDetector yin;
+    yin.setSynchronous(true);
+    yin.prepare(44100.0);
+
+    std::vector<float> block(200000);
+    for (size_t i = 0; i < block.size(); ++i)
+        block[i] = static_cast<float>(std::sin(twoPi * 220.0 * static_cast<double>(i) / 44100.0));
+
+    REQUIRE(yin.feedBlock(block.data(), static_cast<int>(block.size())) == 0);
+    REQUIRE_THAT(static_cast<double>(yin.getResult().frequency), Catch::Matchers::WithinRel(220.0, 0.01));
+}
+
+TEST_CASE("YIN: telemetry counts dropped samples and the FIFO high-water mark")
+{
+    YinPitchDetector yin;
+    yin.prepare(44100.0);
+
+    auto before = yin.getTelemetry();
+    REQUIRE(before.droppedSamples == 0);
+    REQUIRE(before.maxFifoFill == 0);
+    REQUIRE(before.resultAgeMs < 0.0);
+
+    std::vector<float> block(200000, 0.0f);
+    int dropped = yin.feedBlock(block.data(), static_cast<int>(block.size()));
+    dropped += yin.feedBlock(block.data(), 1000);
+
+    auto t = yin.getTelemetry();
+    REQUIRE(t.droppedSamples == static_cast<uint64_t>(dropped));
+    REQUIRE(t.maxFifoFill >= static_cast<int>(block.size()) - dropped);
+    REQUIRE(t.maxFifoFill <= t.fifoCapacity);
+
+    yin.flushForTest();
+    REQUIRE(yin.getTelemetry().fifoFill == 0);
+
+    yin.prepare(44100.0);
+    REQUIRE(yin.getTelemetry().droppedSamples == 0);
+}
+
+TEST_CASE("YIN: telemetry times analyses and the hop latency")
+{
+    const double sr = 48000.0;
+    std::vector<float> tone(static_cast<size_t>(sr / 2));
+    for (size_t i = 0; i < tone.size(); ++i)
+        tone[i] = static_cast<float>(std::sin(twoPi * 220.0 * static_cast<double>(i) / sr));
+
+    SECTION("synchronous: the hop is published within the feedBlock call that completed it")
+    {
+        YinPitchDetector yin;
+        yin.setSynchronous(true);
+        yin.prepare(sr);
+
+        double longestCallMs = 0.0;
+        for (size_t offset = 0; offset + 480 <= tone.size(); offset += 480)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            yin.feedBlock(tone.data() + offset, 480);
+            auto callMs = 1000.0 * juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            longestCallMs = std::max(longestCallMs, callMs);
+        }
+
+        auto t = yin.getTelemetry();
+        REQUIRE(t.numAnalyses > 0);
+        REQUIRE(t.maxAnalyseMs > 0.0);
+        REQUIRE(t.meanAnalyseMs <= t.maxAnalyseMs);
+        REQUIRE(t.maxHopLatencyMs > 0.0);
+        REQUIRE(t.maxHopLatencyMs <= longestCallMs);
+        REQUIRE(t.maxAnalyseMs <= t.maxHopLatencyMs);
+    }
+
+    SECTION("feedSample stamps its writes like feedBlock")
+    {
+        YinPitchDetector yin;
+        yin.setSynchronous(true);
+        yin.setMaxHopSeconds(0.003);
+        yin.prepare(sr);
+
+        for (float sample : tone)
+            yin.feedSample(sample);
+
+        auto t = yin.getTelemetry();
+        REQUIRE(t.numAnalyses > 0);
+        REQUIRE(t.lastHopLatencyMs > 0.0);
+        REQUIRE(t.maxHopLatencyMs > 0.0);
+    }
+
+    SECTION("pooled: latency includes the time the hop waited in the FIFO")
+    {
+        YinPitchDetector yin;
+        yin.prepare(sr);
+
+        for (size_t offset = 0; offset + 480 <= tone.size(); offset += 480)
+        {
+            yin.feedBlock(tone.data() + offset, 480);
+            yin.flushForTest();
+        }
+
+        auto t = yin.getTelemetry();
+        REQUIRE(t.numAnalyses > 0);
+        REQUIRE(t.lastHopLatencyMs > 0.0);
+        REQUIRE(t.lastHopLatencyMs <= t.maxHopLatencyMs);
+        REQUIRE(t.maxHopLatencyMs < 1000.0);
+        REQUIRE(t.resultAgeMs >= 0.0);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        REQUIRE(yin.getTelemetry().resultAgeMs >= 20.0);
+    }
+
+    SECTION("pooled: per-sample feeding at 96 kHz still records the hop latency")
+    {
+        // The hop here is longer than the stamp ring, so stamping every sample
+        // would fill it before the hop completes.
+        const double highRate = 96000.0;
+        YinPitchDetector yin;
+        yin.prepare(highRate);
+
+        for (int ms = 0; ms < 200; ++ms)
+        {
+            for (int i = 0; i < 96; ++i)
+            {
+                auto n = static_cast<double>(ms * 96 + i);
+                yin.feedSample(static_cast<float>(std::sin(twoPi * 220.0 * n / highRate)));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        yin.flushForTest();
+
+        auto t = yin.getTelemetry();
+        REQUIRE(t.numAnalyses > 0);
+        REQUIRE(t.lastHopLatencyMs > 0.0);
+        REQUIRE(t.maxHopLatencyMs < 1000.0);
+    }
+}